@@ -20,14 +20,14 @@ int main()
     }
     
     // 配置ACFS
-    acfs_config_t config;
+    acfs_config_t config = {0};
     config.cluster_size = 256;          // 256字节簇大小
     config.reserved_clusters = 4;       // 保留4个簇用于系统信息
     config.format_if_invalid = true;    // 如果无效则格式化
     config.enable_crc_check = true;     // 启用CRC校验
     
     // 初始化ACFS
-    acfs_t acfs;
+    acfs_t acfs = {0};
     ret = acfs_init(&acfs, &storage, &config);
     if (ret != ACFS_OK) {
         printf("初始化ACFS失败: %s\n", acfs_error_string(ret));
@@ -9,8 +9,8 @@
 extern "C" {
 #endif
 
-/* 版本信息 */
-#define ACFS_VERSION_MAJOR    1
+/* 版本信息（主版本号即磁盘格式版本，格式不兼容时递增） */
+#define ACFS_VERSION_MAJOR    2
 #define ACFS_VERSION_MINOR    0
 #define ACFS_VERSION_PATCH    0
 
@@ -20,6 +20,54 @@ extern "C" {
 #define ACFS_CLUSTER_SIZE_MAX 4096  // 最大簇大小
 #define ACFS_MAX_CLUSTERS     65535 // 最大簇数量
 #define ACFS_MAGIC_NUMBER     0x41434653  // "ACFS"
+#define ACFS_OWNER_NONE       0xFFFF // 簇无所属条目
+#define ACFS_EXTENT_NONE      0xFFFF // 空闲段链表结束
+#define ACFS_EXTENT_CLASSES   16     // 空闲段大小级别数（按长度的2的幂分级）
+
+/* 文件系统标志 */
+#define ACFS_FLAG_CLUSTER_TRAILER   0x0001  // 每簇末尾带回溯尾部
+#define ACFS_FLAG_SNAPSHOT          0x0002  // 存在卷快照
+#define ACFS_FLAG_CACHE             0x0004  // 缓存模式，空间不足时淘汰数据
+
+/* 簇尾部魔数 */
+#define ACFS_TRAILER_MAGIC          0x5443  // 数据簇
+#define ACFS_TRAILER_MAGIC_DELETED  0x5444  // 删除标记
+
+/* 导出归档 */
+#define ACFS_ARCHIVE_MAGIC          0x41434641  // "ACFA"
+#define ACFS_ARCHIVE_END_MAGIC      0x41434645  // "ACFE"
+#define ACFS_ARCHIVE_VERSION        2
+
+/* 数据类型 */
+#define ACFS_TYPE_VALUE             0   // 普通数据
+#define ACFS_TYPE_RING              1   // 环形记录
+#define ACFS_TYPE_QUEUE             2   // 先进先出队列
+#define ACFS_TYPE_COUNTER           3   // 计数器
+
+/* 环形记录 */
+#define ACFS_RING_MAGIC             0x41435247  // "ACRG"
+#define ACFS_RING_CURSORS           4   // 缓存写入位置的环形记录数
+
+/* 空间预留 */
+#define ACFS_RESERVATIONS           4   // 同时存在的预留数
+
+/* 流水线读写 */
+#define ACFS_PIPELINE_CLUSTERS      8       // 流水线每级的簇数，超过一级的数据才走流水线
+
+/* 放置分组 */
+#define ACFS_HINT_NONE              0xFFFF  // 无放置位置提示
+#define ACFS_GROUP_REGIONS          16      // 默认分组区域数
+
+/* 队列 */
+#define ACFS_QUEUE_MAGIC            0x41435155  // "ACQU"
+#define ACFS_QUEUE_RECORD_MAGIC     0x5152      // 消息
+#define ACFS_QUEUE_SKIP_MAGIC       0x5153      // 本簇剩余部分未使用
+#define ACFS_QUEUE_HEADER_SLOT      32          // 队列头两个副本的间距
+
+/* 计数器 */
+#define ACFS_COUNTER_MAGIC          0x41434354  // "ACCT"
+#define ACFS_COUNTER_BASE_SLOT      24          // 基值两个副本的间距
+#define ACFS_COUNTER_LOG_OFFSET     48          // 增量日志在簇内的起始偏移
 
 /* 错误码定义 */
 typedef enum {
@@ -33,7 +81,12 @@ typedef enum {
     ACFS_ERROR_IO_ERROR,           // IO错误
     ACFS_ERROR_INVALID_FILESYSTEM, // 无效文件系统
     ACFS_ERROR_CLUSTER_FULL,       // 簇已满
-    ACFS_ERROR_CRC_MISMATCH        // CRC校验失败
+    ACFS_ERROR_CRC_MISMATCH,       // CRC校验失败
+    ACFS_ERROR_LOG_TRUNCATED,      // 变更日志已截断
+    ACFS_ERROR_BUSY,               // 导出进行中，操作暂不可用
+    ACFS_ERROR_DATA_EXISTS,        // 数据已存在
+    ACFS_ERROR_VERSION_MISMATCH,   // 版本不匹配
+    ACFS_ERROR_QUEUE_EMPTY         // 队列为空
 } acfs_error_t;
 
 /* 存储介质类型 */
@@ -70,9 +123,25 @@ typedef struct {
     uint16_t sys_clusters;      // 系统信息区簇数
     uint16_t data_entries;      // 数据条目数
     uint16_t free_clusters;     // 空闲簇数
+    uint16_t flags;             // 文件系统标志
+    uint16_t snapshot_entries;  // 快照条目数
+    uint32_t sequence;          // 写入序列号
+    uint32_t entries_crc;       // 条目表及簇列表CRC32
+    uint32_t tombstone_floor;   // 已清除的删除标记中最大的修改序列号
     uint32_t crc32;             // 头部CRC32
 } __attribute__((packed)) acfs_header_t;
 
+/* 簇尾部（启用ACFS_FLAG_CLUSTER_TRAILER时位于每个数据簇末尾） */
+typedef struct {
+    uint16_t magic;             // 尾部魔数
+    uint16_t index;             // 簇在数据中的序号
+    uint32_t owner_hash;        // 所属条目标识
+    uint32_t sequence;          // 写入序列号
+    uint32_t data_size;         // 数据总大小（仅末簇有效，其余为0）
+    uint32_t data_crc;          // 数据CRC32（仅末簇有效）
+    uint32_t crc32;             // 有效载荷与尾部CRC32
+} __attribute__((packed)) acfs_cluster_trailer_t;
+
 /* 数据条目信息 */
 typedef struct {
     char data_id[ACFS_MAX_DATA_ID_LEN];  // 数据标识
@@ -80,18 +149,281 @@ typedef struct {
     uint16_t cluster_count;               // 占用簇数
     uint16_t *cluster_list;               // 簇列表
     uint32_t crc32;                       // 数据CRC32
-    bool is_valid;                        // 是否有效
+    uint32_t owner_hash;                  // 所属条目标识（写入簇尾部）
+    uint32_t mod_seq;                     // 最后修改时的写入序列号
+    uint32_t expire_at;                   // 过期时间，0表示永不过期
+    bool is_valid;                        // 是否有效，false为删除标记（保留名称供增量导出）
+    uint8_t referenced;                   // 上次淘汰扫描后被访问过（缓存模式）
+    uint8_t type;                         // 数据类型（ACFS_TYPE_*）
+    uint32_t aux;                         // 类型相关信息（队列：首个数据簇的逻辑序号）
 } acfs_data_entry_t;
 
-/* ACFS实例 */
+/* 归档头 */
+typedef struct {
+    uint32_t magic;             // 归档魔数
+    uint16_t version;           // 归档格式版本
+    uint16_t entry_count;       // 条目数
+    uint32_t sequence;          // 导出时的写入序列号
+    uint32_t base_sequence;     // 增量归档的起点，全量归档为0
+    uint16_t payload;           // 源卷每簇的数据区大小（环形记录、队列和计数器按簇布局）
+    uint32_t crc32;             // 归档头CRC32
+} __attribute__((packed)) acfs_archive_header_t;
+
+/* 归档条目记录头，其后紧跟data_size字节数据；data_size为0表示已删除 */
+typedef struct {
+    char data_id[ACFS_MAX_DATA_ID_LEN];  // 数据标识
+    uint32_t data_size;                   // 数据大小
+    uint32_t data_crc;                    // 数据CRC32
+    uint8_t type;                         // 数据类型（ACFS_TYPE_*）
+    uint32_t aux;                         // 类型相关信息，同acfs_data_entry_t.aux
+    uint32_t crc32;                       // 记录头CRC32
+} __attribute__((packed)) acfs_archive_record_t;
+
+/* 归档尾 */
+typedef struct {
+    uint32_t magic;             // 归档结束魔数
+    uint32_t crc32;             // 此前全部字节的CRC32
+} __attribute__((packed)) acfs_archive_footer_t;
+
+/* 导出输出回调，成功返回0 */
+typedef int (*acfs_stream_write_t)(const void* data, size_t size, void* user_data);
+
+/* 导入输入回调，须读满size字节，成功返回0 */
+typedef int (*acfs_stream_read_t)(void* data, size_t size, void* user_data);
+
+/* 变更类型 */
+typedef enum {
+    ACFS_CHANGE_WRITE = 0,          // 写入
+    ACFS_CHANGE_DELETE              // 删除
+} acfs_change_op_t;
+
+/* 变更记录 */
+typedef struct {
+    uint32_t sequence;                    // 写入序列号
+    uint8_t op;                           // 变更类型（acfs_change_op_t）
+    uint8_t type;                         // 条目的数据类型（ACFS_TYPE_*）
+    char data_id[ACFS_MAX_DATA_ID_LEN];   // 数据标识
+    uint32_t data_size;                   // 变更后的数据大小
+    uint32_t crc32;                       // 变更后的数据CRC32
+} acfs_change_record_t;
+
+/* 变更回调，返回非ACFS_OK时停止遍历 */
+typedef acfs_error_t (*acfs_change_callback_t)(const acfs_change_record_t* record, void* user_data);
+
+/* 条目遍历回调，返回非ACFS_OK时停止遍历 */
+typedef acfs_error_t (*acfs_foreach_callback_t)(const char* data_id, size_t size, void* user_data);
+
+/* 过期索引项（按过期时间排列的最小堆） */
+typedef struct {
+    uint32_t expire_at;             // 过期时间
+    uint16_t slot;                  // 条目槽位
+} acfs_expiry_t;
+
+/* 环形记录头（位于首簇） */
+typedef struct {
+    uint32_t magic;             // 环形记录魔数
+    uint16_t record_size;       // 每条记录大小
+    uint16_t per_cluster;       // 每簇容纳的记录数
+    uint32_t capacity;          // 记录容量
+    uint32_t crc32;             // 前述字段的CRC32
+} __attribute__((packed)) acfs_ring_header_t;
+
+/* 环形记录槽头（位于每条记录之前） */
+typedef struct {
+    uint64_t seq;               // 记录序号，从1开始，0表示空槽；64位不会回绕
+    uint32_t crc32;             // 序号和记录内容的CRC32
+} __attribute__((packed)) acfs_ring_slot_t;
+
+/* 队列头（首簇中交替写入两个副本，取有效且seq较大的一个） */
 typedef struct {
+    uint32_t magic;             // 队列魔数
+    uint32_t seq;               // 更新次数
+    uint32_t head_cluster;      // 队首所在数据簇的逻辑序号
+    uint32_t tail_cluster;      // 队尾所在数据簇的逻辑序号
+    uint16_t head_offset;       // 队首在簇内的偏移
+    uint16_t tail_offset;       // 队尾在簇内的偏移
+    uint32_t count;             // 消息数
+    uint32_t crc32;             // 前述字段的CRC32
+} __attribute__((packed)) acfs_queue_header_t;
+
+/* 队列消息头 */
+typedef struct {
+    uint16_t size;              // 消息大小
+    uint16_t magic;             // 消息或跳过标记
+    uint32_t crc32;             // 消息内容的CRC32
+} __attribute__((packed)) acfs_queue_record_t;
+
+/* 计数器基值（簇内交替写入两个副本，取有效且generation较大的一个） */
+typedef struct {
+    uint32_t magic;             // 计数器魔数
+    uint32_t generation;        // 压缩次数
+    uint64_t value;             // 压缩时的计数值
+    uint32_t crc32;             // 前述字段的CRC32
+} __attribute__((packed)) acfs_counter_base_t;
+
+/* 计数器增量日志记录，全0xFF表示未写入 */
+typedef struct {
+    uint32_t delta;             // 增量
+    uint32_t check;             // 增量和所属generation的CRC32
+} __attribute__((packed)) acfs_counter_record_t;
+
+/* 队列批量出队回调，返回非ACFS_OK时停止，该消息保留在队列中 */
+typedef acfs_error_t (*acfs_queue_callback_t)(const void* data, size_t size, void* user_data);
+
+/* 环形记录写入位置缓存 */
+typedef struct {
+    uint32_t owner_hash;        // 所属条目标识，0表示空闲
+    uint64_t next_seq;          // 下一条记录的序号
+    uint16_t record_size;       // 每条记录大小
+    uint16_t per_cluster;       // 每簇容纳的记录数
+    uint32_t capacity;          // 记录容量
+} acfs_ring_cursor_t;
+
+/* 空间预留（只保存在内存中） */
+typedef struct {
+    char data_id[ACFS_MAX_DATA_ID_LEN]; // 预留给的数据标识，空串表示空闲
+    uint16_t next;                  // 下一个待分配的簇
+    uint16_t remaining;             // 剩余的预留簇数
+} acfs_reservation_t;
+
+/* 单簇分配缓存（预先从分配策略取出的一段连续簇，位图中已标记但仍计入空闲簇数） */
+typedef struct {
+    uint16_t next;                  // 下一个交出的簇
+    uint16_t remaining;             // 剩余簇数
+} acfs_magazine_t;
+
+/* 分散写入的数据段 */
+typedef struct {
+    const void* data;               // 数据段
+    size_t size;                    // 数据段大小
+} acfs_iovec_t;
+
+/* 条目元数据（acfs_stat） */
+typedef struct {
+    size_t size;                    // 数据大小
+    uint32_t crc32;                 // 存储的数据CRC32
+    uint32_t version;               // 版本号（修改序列号），可用于acfs_write_if_version
+    uint32_t expire_at;             // 过期时间，0表示永不过期
+    uint16_t cluster_count;         // 占用簇数
+    uint16_t extent_count;          // 连续簇段数
+    uint8_t type;                   // 数据类型
+    bool pinned;                    // 是否固定在值缓存中
+} acfs_stat_t;
+
+/* 值缓存项 */
+typedef struct {
+    uint32_t mod_seq;               // 缓存的数据版本（条目的修改序列号）
+    uint32_t size;                  // 数据大小
+    bool pinned;                    // 常驻，不被换出
+    uint8_t data[];                 // 已校验的数据
+} acfs_cached_value_t;
+
+/* 时间源，返回当前时间（秒） */
+typedef uint32_t (*acfs_time_callback_t)(void);
+
+/* 空闲段索引节点（按簇号索引，只有段首和段尾的节点有效） */
+typedef struct {
+    uint16_t length;                // 以该簇开头的空闲段长度，0表示不是段首
+    uint16_t next;                  // 同一大小级别中的下一段
+    uint16_t prev;                  // 同一大小级别中的上一段
+    uint16_t start;                 // 以该簇结尾的空闲段的段首
+} acfs_extent_node_t;
+
+/* 空闲段索引（连续段分配策略的状态） */
+typedef struct {
+    uint16_t head[ACFS_EXTENT_CLASSES];  // 各大小级别的空闲段链表
+    acfs_extent_node_t nodes[];     // 按簇号索引的节点
+} acfs_extent_index_t;
+
+/* 分配统计（acfs_get_alloc_stats） */
+typedef struct {
+    uint16_t free_clusters;         // 空闲簇数
+    uint16_t free_extents;          // 空闲段数
+    uint16_t largest_extent;        // 最长空闲段的簇数
+} acfs_alloc_stats_t;
+
+typedef struct acfs acfs_t;
+
+/* 簇分配策略，位图和簇列表由核心维护，策略只选择空闲簇 */
+typedef struct {
+    const char* name;               // 策略名称
+    /* 挂载或位图整体变化（碎片整理）后按位图建立内部状态，可重复调用 */
+    acfs_error_t (*mount)(acfs_t* acfs);
+    /* 释放内部状态 */
+    void (*unmount)(acfs_t* acfs);
+    /* 取出一段至多count簇的连续空闲簇，段首写入start，返回簇数，0表示无空闲；
+       contiguous为true时只接受不少于count簇的段；hint不为ACFS_HINT_NONE时优先取hint处或其后的空闲簇 */
+    uint16_t (*allocate)(acfs_t* acfs, uint16_t count, bool contiguous, uint16_t hint, uint16_t* start);
+    /* 归还一段簇，调用时位图中对应位已清除 */
+    void (*release)(acfs_t* acfs, uint16_t start, uint16_t length);
+    /* 累加空闲空间统计 */
+    void (*stats)(const acfs_t* acfs, acfs_alloc_stats_t* stats);
+} acfs_allocator_t;
+
+/* 内置分配策略 */
+extern const acfs_allocator_t acfs_allocator_first_fit;  // 从低地址取第一个空闲簇（早期版本的行为）
+extern const acfs_allocator_t acfs_allocator_extent;     // 按大小级别索引空闲段，优先整段分配（默认）
+
+/* 并行任务：处理下标为index的工作项，worker为执行它的工作线程序号（小于执行器的workers） */
+typedef void (*acfs_task_t)(void* arg, uint32_t index, uint16_t worker);
+
+/* 执行器，内部并行操作通过它执行；可用acfs_executor_create创建，也可接入宿主应用自己的线程池 */
+typedef struct {
+    /* 执行count个工作项，全部完成后返回；同一工作线程序号不得同时执行两个工作项 */
+    void (*parallel_for)(void* context, acfs_task_t task, void* arg, uint32_t count);
+    uint16_t workers;               // 工作线程数，决定各操作按线程分配的缓冲区数
+    void* context;                  // 传给parallel_for的上下文
+} acfs_executor_t;
+
+/* 簇反向映射项 */
+typedef struct {
+    uint16_t slot;                  // 所属条目槽位
+    uint16_t index;                 // 在簇列表中的序号
+} acfs_cluster_owner_t;
+
+/* ACFS实例 */
+struct acfs {
     storage_device_t* storage;      // 存储设备
     acfs_header_t header;           // 系统头
     acfs_data_entry_t* entries;     // 数据条目表
     uint8_t* cluster_bitmap;        // 簇位图
+    acfs_cluster_owner_t* cluster_owner; // 簇反向映射（簇 -> 条目）
     bool initialized;               // 初始化标志
     uint8_t* cluster_buffer;        // 簇缓冲区
-} acfs_t;
+    acfs_change_record_t* change_log;    // 变更日志环形缓冲区
+    uint16_t change_log_capacity;   // 变更日志容量
+    uint16_t change_log_head;       // 最旧记录位置
+    uint16_t change_log_count;      // 记录数
+    uint32_t change_log_floor;      // 不晚于此序列号的变更已不可追溯
+    uint8_t* cluster_refs;          // 簇引用计数（条目、快照和进行中的导出各计一次）
+    const acfs_allocator_t* allocator;   // 簇分配策略
+    void* allocator_state;          // 分配策略的内部状态
+    acfs_data_entry_t* snapshot;    // 快照条目表
+    uint16_t freeze_count;          // 进行中的导出数，非0时不做碎片整理
+    acfs_time_callback_t get_time;  // 时间源
+    acfs_expiry_t* expiry_heap;     // 过期索引
+    uint16_t expiry_count;          // 过期索引项数
+    uint16_t expiry_capacity;       // 过期索引容量
+    bool expiry_dirty;              // 过期索引需要重建（槽位移动后）
+    uint16_t clock_hand;            // 缓存淘汰扫描位置
+    uint16_t* name_index;           // 名称哈希索引（开放寻址，存槽位+1）
+    uint16_t name_index_mask;       // 名称哈希索引容量-1
+    bool name_index_dirty;          // 名称哈希索引需要重建
+    acfs_cached_value_t** value_cache;  // 值缓存，按条目槽位索引
+    uint32_t value_cache_size;      // 值缓存容量（字节）
+    uint32_t value_cache_used;      // 值缓存已用（字节）
+    uint16_t value_cache_max_value; // 读取时自动缓存的最大值（字节）
+    uint16_t value_cache_hand;      // 值缓存换出扫描位置
+    acfs_ring_cursor_t ring_cursor[ACFS_RING_CURSORS];  // 环形记录写入位置
+    uint8_t ring_cursor_next;       // 下一个替换的写入位置缓存
+    acfs_reservation_t reservations[ACFS_RESERVATIONS]; // 空间预留
+    char group_separator;           // 自动分组的分隔符，0表示不按前缀分组
+    uint16_t group_regions;         // 分组区域数
+    const char* placement_group;    // 当前写入的显式分组（仅在acfs_write_group期间有效）
+    acfs_magazine_t magazine;       // 单簇分配缓存
+    uint8_t magazine_size;          // 单簇分配缓存每次补充的簇数，0表示禁用
+    const acfs_executor_t* executor;    // 内部并行操作的执行器，NULL表示在调用线程中顺序执行
+};
 
 /* 初始化配置 */
 typedef struct {
@@ -99,8 +431,39 @@ typedef struct {
     uint16_t reserved_clusters;     // 保留系统信息区簇数
     bool format_if_invalid;         // 如果无效是否格式化
     bool enable_crc_check;          // 是否启用CRC校验
+    bool enable_cluster_trailer;    // 格式化时启用簇尾部（用于acfs_fsck）
+    bool cache_mode;                // 格式化时启用缓存模式（空间不足时自动淘汰数据）
+    uint16_t change_log_size;       // 变更日志容量（条），0表示禁用
+    acfs_time_callback_t get_time;  // 时间源（秒），使用acfs_write_ttl时必须提供
+    uint32_t value_cache_size;      // 值缓存容量（字节），0表示禁用
+    uint16_t value_cache_max_value; // 读取时自动缓存的最大值（字节），0表示只缓存固定的数据
+    const acfs_allocator_t* allocator;  // 簇分配策略，NULL表示acfs_allocator_extent
+    char group_separator;           // 按数据标识中最后一个分隔符之前的前缀自动分组，0表示禁用
+    uint16_t group_regions;         // 数据区划分的分组区域数，0表示ACFS_GROUP_REGIONS
+    uint8_t magazine_size;          // 单簇分配缓存每次补充的簇数，0表示禁用
+    const acfs_executor_t* executor;    // 内部并行操作的执行器，NULL表示顺序执行；可由多个实例共享
 } acfs_config_t;
 
+/* 元数据重建报告 */
+typedef struct {
+    uint16_t clusters_scanned;      // 扫描的簇数
+    uint16_t clusters_valid;        // 尾部校验通过的簇数
+    uint16_t entries_recovered;     // 恢复的条目数
+    uint16_t entries_unnamed;       // 无法找回名称的条目数（命名为lost.xxxxxxxx）
+    uint16_t entries_dropped;       // 不完整而丢弃的条目数
+} acfs_fsck_report_t;
+
+/* 本地复制器 */
+typedef struct {
+    acfs_t* source;                 // 源实例
+    acfs_t* target;                 // 目标实例
+    uint32_t sequence;              // 已同步到的源端序列号
+    bool need_full_sync;            // 下次同步需要全量同步
+    uint8_t* buffer;                // 值缓冲区
+    size_t buffer_size;             // 值缓冲区大小
+    uint32_t skipped;               // 未复制的环形记录、队列和计数器的条目及变更数（累计）
+} acfs_replica_t;
+
 /* 核心API接口 */
 
 /**
@@ -137,6 +500,42 @@ acfs_error_t acfs_format(acfs_t* acfs, const acfs_config_t* config);
  */
 acfs_error_t acfs_write(acfs_t* acfs, const char* data_id, const void* data, size_t size);
 
+/**
+ * 分散写入：把多个数据段按顺序拼接为一条数据写入，无需先复制到连续缓冲区
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @param iov 数据段数组
+ * @param iovcnt 数据段个数
+ * @return 错误码
+ */
+acfs_error_t acfs_writev(acfs_t* acfs, const char* data_id, const acfs_iovec_t* iov, uint16_t iovcnt);
+
+/**
+ * 写入带过期时间的数据
+ * 过期后读取、存在性检查和遍历都看不到该数据，其空间由acfs_expire批量回收。
+ * 普通写入会清除过期时间。
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @param data 数据
+ * @param size 数据大小
+ * @param ttl 有效期（秒），0表示永不过期
+ * @return 错误码，未配置时间源时返回ACFS_ERROR_INVALID_PARAM
+ */
+acfs_error_t acfs_write_ttl(acfs_t* acfs, const char* data_id, const void* data, size_t size, uint32_t ttl);
+
+/**
+ * 按指定分组写入数据
+ * 同一分组的数据新分配的簇集中在该分组的区域内，批量读取时接近顺序访问。
+ * 分组只影响簇的位置，不保存在条目中；之后的普通写入按自动分组规则分配。
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @param group 分组名
+ * @param data 数据
+ * @param size 数据大小
+ * @return 错误码
+ */
+acfs_error_t acfs_write_group(acfs_t* acfs, const char* data_id, const char* group, const void* data, size_t size);
+
 /**
  * 读取数据
  * @param acfs ACFS实例
@@ -148,6 +547,53 @@ acfs_error_t acfs_write(acfs_t* acfs, const char* data_id, const void* data, siz
  */
 acfs_error_t acfs_read(acfs_t* acfs, const char* data_id, void* data, size_t size, size_t* actual_size);
 
+/**
+ * 读取数据及其版本号
+ * 版本号即条目最后修改时的写入序列号，每次写入都会变化且全卷不重复。
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @param data 数据缓冲区
+ * @param size 缓冲区大小
+ * @param actual_size 实际读取大小
+ * @param version 版本号输出
+ * @return 错误码
+ */
+acfs_error_t acfs_read_version(acfs_t* acfs, const char* data_id, void* data, size_t size,
+                               size_t* actual_size, uint32_t* version);
+
+/**
+ * 版本号匹配时才写入（比较并交换）
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @param expected_version 期望的当前版本号，0表示数据必须不存在
+ * @param data 数据
+ * @param size 数据大小
+ * @param new_version 写入后的版本号输出（可选）
+ * @return 错误码，版本号不匹配时返回ACFS_ERROR_VERSION_MISMATCH且不写入
+ */
+acfs_error_t acfs_write_if_version(acfs_t* acfs, const char* data_id, uint32_t expected_version,
+                                   const void* data, size_t size, uint32_t* new_version);
+
+/**
+ * 截短数据
+ * 只释放尾部的簇并改写新的末簇，保留的簇不搬移。
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @param size 新大小，不超过当前大小且大于0
+ * @return 错误码
+ */
+acfs_error_t acfs_truncate(acfs_t* acfs, const char* data_id, size_t size);
+
+/**
+ * 调整数据大小
+ * 缩短同acfs_truncate；增长部分补零，只写入新增的簇，不读取原有数据。
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @param size 新大小，大于0
+ * @return 错误码
+ */
+acfs_error_t acfs_resize(acfs_t* acfs, const char* data_id, size_t size);
+
 /**
  * 删除数据
  * @param acfs ACFS实例
@@ -156,6 +602,17 @@ acfs_error_t acfs_read(acfs_t* acfs, const char* data_id, void* data, size_t siz
  */
 acfs_error_t acfs_delete(acfs_t* acfs, const char* data_id);
 
+/**
+ * 重命名数据，不搬移数据
+ * 只修改条目表并提交一次元数据；旧名称留下删除标记供增量导出。
+ * @param acfs ACFS实例
+ * @param old_id 原数据标识
+ * @param new_id 新数据标识
+ * @param replace_existing 新标识已存在时是否替换（被替换条目的簇随之释放）
+ * @return 错误码，新标识已存在且不替换时返回ACFS_ERROR_DATA_EXISTS
+ */
+acfs_error_t acfs_rename(acfs_t* acfs, const char* old_id, const char* new_id, bool replace_existing);
+
 /**
  * 检查数据是否存在
  * @param acfs ACFS实例
@@ -164,6 +621,16 @@ acfs_error_t acfs_delete(acfs_t* acfs, const char* data_id);
  */
 bool acfs_exists(acfs_t* acfs, const char* data_id);
 
+/**
+ * 遍历所有数据条目
+ * 回调中不得修改文件系统。
+ * @param acfs ACFS实例
+ * @param callback 条目回调
+ * @param user_data 用户数据
+ * @return 错误码，回调返回非ACFS_OK时原样返回
+ */
+acfs_error_t acfs_foreach(acfs_t* acfs, acfs_foreach_callback_t callback, void* user_data);
+
 /**
  * 获取数据大小
  * @param acfs ACFS实例
@@ -173,6 +640,29 @@ bool acfs_exists(acfs_t* acfs, const char* data_id);
  */
 acfs_error_t acfs_get_size(acfs_t* acfs, const char* data_id, size_t* size);
 
+/**
+ * 获取条目元数据
+ * 只读取内存中的条目表，不访问存储设备。
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @param info 元数据输出
+ * @return 错误码
+ */
+acfs_error_t acfs_stat(acfs_t* acfs, const char* data_id, acfs_stat_t* info);
+
+/**
+ * 批量获取条目元数据
+ * @param acfs ACFS实例
+ * @param data_ids 数据标识数组
+ * @param count 数据标识数
+ * @param infos 元数据输出数组，未找到的数据清零
+ * @param results 每个标识的错误码输出数组（可选）
+ * @param found 找到的数据数输出（可选）
+ * @return 错误码，个别数据未找到不视为错误
+ */
+acfs_error_t acfs_stat_batch(acfs_t* acfs, const char* const* data_ids, uint16_t count,
+                             acfs_stat_t* infos, acfs_error_t* results, uint16_t* found);
+
 /**
  * 获取空闲空间
  * @param acfs ACFS实例
@@ -181,6 +671,14 @@ acfs_error_t acfs_get_size(acfs_t* acfs, const char* data_id, size_t* size);
  */
 acfs_error_t acfs_get_free_space(acfs_t* acfs, size_t* free_size);
 
+/**
+ * 获取簇分配策略的空闲段统计
+ * @param acfs ACFS实例
+ * @param stats 统计输出
+ * @return 错误码
+ */
+acfs_error_t acfs_get_alloc_stats(acfs_t* acfs, acfs_alloc_stats_t* stats);
+
 /**
  * 获取系统统计信息
  * @param acfs ACFS实例
@@ -193,13 +691,192 @@ acfs_error_t acfs_get_free_space(acfs_t* acfs, size_t* free_size);
 acfs_error_t acfs_get_stats(acfs_t* acfs, size_t* total_size, size_t* used_size, 
                            size_t* free_size, uint16_t* data_count);
 
+/**
+ * 按序列号顺序回放指定序列号之后的变更
+ * 变更日志是内存中的有界环形缓冲区，挂载时为空。
+ * @param acfs ACFS实例
+ * @param sequence 已处理到的序列号，只回放大于它的记录
+ * @param callback 变更回调
+ * @param user_data 用户数据
+ * @return 错误码，所需记录已被覆盖或早于挂载时返回ACFS_ERROR_LOG_TRUNCATED
+ */
+acfs_error_t acfs_changes_since(acfs_t* acfs, uint32_t sequence, acfs_change_callback_t callback, void* user_data);
+
+/**
+ * 获取当前写入序列号
+ * @param acfs ACFS实例
+ * @param sequence 序列号输出
+ * @return 错误码
+ */
+acfs_error_t acfs_get_sequence(acfs_t* acfs, uint32_t* sequence);
+
 /**
  * 数据完整性检查
+ * 配置了执行器时，普通数据的CRC校验并行进行（存储设备的read须可并发调用）。
  * @param acfs ACFS实例
  * @return 错误码
  */
 acfs_error_t acfs_check_integrity(acfs_t* acfs);
 
+/**
+ * 创建环形记录
+ * 首簇保存记录大小和容量，其余簇按槽存放定长记录，写满后覆盖最旧的记录。
+ * 未启用簇尾部的卷才能创建。
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @param record_size 每条记录大小
+ * @param capacity 记录容量
+ * @return 错误码，同名数据已存在时返回ACFS_ERROR_DATA_EXISTS
+ */
+acfs_error_t acfs_ring_create(acfs_t* acfs, const char* data_id, uint16_t record_size, uint32_t capacity);
+
+/**
+ * 追加一条记录
+ * 只写入一个记录槽，不改写元数据。
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @param record 记录，长度为创建时的record_size
+ * @return 错误码
+ */
+acfs_error_t acfs_ring_push(acfs_t* acfs, const char* data_id, const void* record);
+
+/**
+ * 读取最新的若干条记录，按写入顺序由旧到新排列
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @param records 记录缓冲区
+ * @param max_records 最多读取的记录数
+ * @param count 实际读取的记录数输出
+ * @return 错误码
+ */
+acfs_error_t acfs_ring_read_range(acfs_t* acfs, const char* data_id, void* records,
+                                  uint32_t max_records, uint32_t* count);
+
+/**
+ * 创建队列
+ * 首簇保存队首和队尾位置，消息顺序存放在其后的数据簇中，不跨簇。
+ * 未启用簇尾部的卷才能创建。
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @return 错误码，同名数据已存在时返回ACFS_ERROR_DATA_EXISTS
+ */
+acfs_error_t acfs_queue_create(acfs_t* acfs, const char* data_id);
+
+/**
+ * 消息入队
+ * 写入一条消息和一次队列头；队尾进入新簇时才追加簇并提交元数据。
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @param data 消息
+ * @param size 消息大小，不超过每簇有效载荷减去8字节消息头
+ * @return 错误码
+ */
+acfs_error_t acfs_queue_push(acfs_t* acfs, const char* data_id, const void* data, size_t size);
+
+/**
+ * 消息出队
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @param data 消息缓冲区
+ * @param size 缓冲区大小
+ * @param actual_size 消息大小输出（可选）
+ * @return 错误码，队列为空时返回ACFS_ERROR_QUEUE_EMPTY，缓冲区不足时返回ACFS_ERROR_INVALID_PARAM且不出队
+ */
+acfs_error_t acfs_queue_pop(acfs_t* acfs, const char* data_id, void* data, size_t size, size_t* actual_size);
+
+/**
+ * 批量出队
+ * 依次把消息交给回调，最后只写一次队列头，并一次回收全部已读完的簇。
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @param max_messages 最多出队的消息数，0表示不限
+ * @param callback 消息回调
+ * @param user_data 用户数据
+ * @param popped 出队的消息数输出（可选）
+ * @return 错误码，回调返回的错误原样返回
+ */
+acfs_error_t acfs_queue_pop_batch(acfs_t* acfs, const char* data_id, uint32_t max_messages,
+                                  acfs_queue_callback_t callback, void* user_data, uint32_t* popped);
+
+/**
+ * 获取队列中的消息数
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @param count 消息数输出
+ * @return 错误码
+ */
+acfs_error_t acfs_queue_length(acfs_t* acfs, const char* data_id, uint32_t* count);
+
+/**
+ * 创建计数器
+ * 计数器占用一个簇：簇首保存基值，其后为增量日志。每次累加只追加一条8字节日志，
+ * 不擦除也不改写元数据；日志写满时把总和压缩进基值。未启用簇尾部的卷才能创建。
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @param initial 初始值
+ * @return 错误码，同名数据已存在时返回ACFS_ERROR_DATA_EXISTS
+ */
+acfs_error_t acfs_counter_create(acfs_t* acfs, const char* data_id, uint64_t initial);
+
+/**
+ * 计数器累加
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @param delta 增量
+ * @param value 累加后的值输出（可选）
+ * @return 错误码
+ */
+acfs_error_t acfs_counter_add(acfs_t* acfs, const char* data_id, uint32_t delta, uint64_t* value);
+
+/**
+ * 读取计数器（基值加上日志中的全部增量）
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @param value 计数值输出
+ * @return 错误码
+ */
+acfs_error_t acfs_counter_get(acfs_t* acfs, const char* data_id, uint64_t* value);
+
+/**
+ * 把数据固定在值缓存中
+ * 固定的数据常驻内存，读取只需一次哈希查找和内存复制；覆盖写入后缓存随之更新，
+ * 删除后固定失效。
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @return 错误码，未启用值缓存时返回ACFS_ERROR_INVALID_PARAM，缓存容量不足时返回ACFS_ERROR_NO_SPACE
+ */
+acfs_error_t acfs_pin(acfs_t* acfs, const char* data_id);
+
+/**
+ * 取消固定，数据仍留在缓存中但可被换出
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @return 错误码
+ */
+acfs_error_t acfs_unpin(acfs_t* acfs, const char* data_id);
+
+/**
+ * 预取即将读取的数据到值缓存
+ * 按首簇地址排序后读取，簇号相邻的簇合并为一次设备读取，CRC校验交给执行器并行完成。
+ * 不存在、已缓存或不是普通数据的标识被忽略；预取的数据不固定，可被换出。
+ * @param acfs ACFS实例
+ * @param data_ids 数据标识数组
+ * @param count 数据标识数量
+ * @param loaded 本次载入缓存的数据数输出（可选）
+ * @return 错误码，未启用值缓存时返回ACFS_ERROR_INVALID_PARAM
+ */
+acfs_error_t acfs_prefetch(acfs_t* acfs, const char* const* data_ids, uint16_t count, uint16_t* loaded);
+
+/**
+ * 回收已过期的数据
+ * 按过期时间顺序取出已过期的条目，转为删除标记并释放簇，整批只提交一次元数据。
+ * @param acfs ACFS实例
+ * @param max_batch 本次最多回收的条目数，0表示不限
+ * @param reclaimed 回收的条目数输出（可选）
+ * @return 错误码
+ */
+acfs_error_t acfs_expire(acfs_t* acfs, uint16_t max_batch, uint16_t* reclaimed);
+
 /**
  * 碎片整理
  * @param acfs ACFS实例
@@ -207,6 +884,153 @@ acfs_error_t acfs_check_integrity(acfs_t* acfs);
  */
 acfs_error_t acfs_defragment(acfs_t* acfs);
 
+/**
+ * 为数据预留一段连续的簇
+ * 预留的簇在位图中标记为已用，该数据之后写入、增长时优先按顺序使用预留的簇，
+ * 流式增长的数据因此连续存放且不会中途空间不足。已有数据只预留超出现有簇数的部分。
+ * 预留只保存在内存中，重新挂载后未使用的部分自动归还。
+ * @param acfs ACFS实例
+ * @param data_id 数据标识（数据可以尚不存在）
+ * @param expected_size 预计的最终大小
+ * @return 错误码，没有足够长的连续空闲簇时返回ACFS_ERROR_NO_SPACE，预留数已满时返回ACFS_ERROR_BUSY
+ */
+acfs_error_t acfs_reserve(acfs_t* acfs, const char* data_id, size_t expected_size);
+
+/**
+ * 归还预留中未使用的簇
+ * @param acfs ACFS实例
+ * @param data_id 数据标识
+ * @return 错误码，没有该数据的预留时返回ACFS_ERROR_DATA_NOT_FOUND
+ */
+acfs_error_t acfs_release_reservation(acfs_t* acfs, const char* data_id);
+
+/**
+ * 查询簇的所属条目
+ * @param acfs ACFS实例
+ * @param cluster 簇号
+ * @param slot 所属条目槽位输出（可选）
+ * @param index 在簇列表中的序号输出（可选）
+ * @return 错误码，空闲簇或系统簇返回ACFS_ERROR_DATA_NOT_FOUND
+ */
+acfs_error_t acfs_get_cluster_owner(acfs_t* acfs, uint16_t cluster, uint16_t* slot, uint16_t* index);
+
+/**
+ * 从簇尾部重建元数据（条目表、簇列表和位图）
+ * 对存储介质做一次顺序扫描，用簇CRC校验每个簇，重建后写回系统区。
+ * 要求文件系统格式化时启用了簇尾部。
+ * @param storage 存储设备（不得处于挂载状态）
+ * @param config 配置参数，头部损坏时用于推断布局
+ * @param report 重建报告输出（可选）
+ * @return 错误码
+ */
+acfs_error_t acfs_fsck(storage_device_t* storage, const acfs_config_t* config, acfs_fsck_report_t* report);
+
+/* 快照 */
+
+/**
+ * 创建卷快照，替换已有快照
+ * 只复制条目表并增加簇引用计数，不复制数据；之后对共享簇的写入写到新簇。
+ * 快照随元数据持久化，占用系统区空间。
+ * @param acfs ACFS实例
+ * @return 错误码，系统区容纳不下快照条目表时返回ACFS_ERROR_NO_SPACE
+ */
+acfs_error_t acfs_snapshot_create(acfs_t* acfs);
+
+/**
+ * 把全部条目回滚到快照时的状态，快照保留
+ * 快照之后创建的条目被删除；变更日志被截断，复制器随后做全量同步。
+ * @param acfs ACFS实例
+ * @return 错误码，没有快照时返回ACFS_ERROR_DATA_NOT_FOUND
+ */
+acfs_error_t acfs_snapshot_restore(acfs_t* acfs);
+
+/**
+ * 删除卷快照，回收只被快照引用的簇
+ * @param acfs ACFS实例
+ * @return 错误码，没有快照时返回ACFS_ERROR_DATA_NOT_FOUND
+ */
+acfs_error_t acfs_snapshot_delete(acfs_t* acfs);
+
+/* 导出与导入 */
+
+/**
+ * 以流式方式导出全部条目的一致性快照，包括环形记录、队列和计数器
+ * 导出期间（包括在write_cb中）发生的写入和删除不影响导出内容：导出持有所有簇的
+ * 引用，被覆盖或删除的簇在导出结束前不会回收。数据按簇读出并校验，内存占用为一个簇。
+ * @param acfs ACFS实例
+ * @param write_cb 输出回调
+ * @param user_data 回调参数
+ * @return 错误码
+ */
+acfs_error_t acfs_export(acfs_t* acfs, acfs_stream_write_t write_cb, void* user_data);
+
+/**
+ * 增量导出：只导出修改序列号大于since的条目，以及此后删除的条目（data_size为0的记录）
+ * since通常取上次归档头中的sequence。环形记录、队列和计数器就地更新不改变修改序列号，总是导出。
+ * @param acfs ACFS实例
+ * @param since 起点序列号
+ * @param write_cb 输出回调
+ * @param user_data 回调参数
+ * @return 错误码，所需删除标记已被清除时返回ACFS_ERROR_LOG_TRUNCATED，需改做全量导出
+ */
+acfs_error_t acfs_export_since(acfs_t* acfs, uint32_t since, acfs_stream_write_t write_cb, void* user_data);
+
+/**
+ * 从acfs_export或acfs_export_since生成的归档批量导入条目
+ * 同名条目被覆盖，删除记录删除同名条目；全部条目写入后只提交一次元数据。
+ * 环形记录、队列和计数器按簇原样写入，要求目标卷每簇数据区大小与源卷相同且未启用簇尾部，
+ * 否则返回ACFS_ERROR_INVALID_PARAM。
+ * 中途失败时已写入的条目保留，数据不完整的条目读取时报告CRC错误。
+ * @param acfs ACFS实例
+ * @param read_cb 输入回调
+ * @param user_data 回调参数
+ * @return 错误码
+ */
+acfs_error_t acfs_import(acfs_t* acfs, acfs_stream_read_t read_cb, void* user_data);
+
+/* 复制 */
+
+/**
+ * 初始化本地复制器
+ * @param replica 复制器
+ * @param source 源实例（需启用变更日志）
+ * @param target 目标实例
+ * @return 错误码
+ */
+acfs_error_t acfs_replica_init(acfs_replica_t* replica, acfs_t* source, acfs_t* target);
+
+/**
+ * 把源端自上次同步以来的变更应用到目标端
+ * 首次同步或变更日志已截断时自动执行全量同步。
+ * 环形记录、队列和计数器就地更新不记入变更日志，不复制，跳过的个数累计在replica->skipped中。
+ * @param replica 复制器
+ * @return 错误码
+ */
+acfs_error_t acfs_replica_sync(acfs_replica_t* replica);
+
+/**
+ * 释放复制器资源
+ * @param replica 复制器
+ */
+void acfs_replica_deinit(acfs_replica_t* replica);
+
+/* 执行器 */
+
+/**
+ * 创建内置执行器（固定线程池，工作项按区间分配并在线程间窃取）
+ * @param executor 执行器
+ * @param workers 工作线程数，含调用parallel_for的线程，1表示不创建线程
+ * @return 错误码
+ */
+acfs_error_t acfs_executor_create(acfs_executor_t* executor, uint16_t workers);
+
+/**
+ * 停止工作线程并释放内置执行器，使用它的实例须已反初始化
+ * @param executor 执行器
+ * @return 错误码，不是acfs_executor_create创建的执行器时返回ACFS_ERROR_INVALID_PARAM
+ */
+acfs_error_t acfs_executor_destroy(acfs_executor_t* executor);
+
 /* 工具函数 */
 
 /**
@@ -224,6 +1048,28 @@ const char* acfs_error_string(acfs_error_t error);
  */
 uint32_t acfs_crc32(const void* data, size_t size);
 
+/**
+ * 开始递增式CRC32计算
+ * @return 初始CRC值
+ */
+uint32_t acfs_crc32_init(void);
+
+/**
+ * 递增式CRC32计算
+ * @param crc 当前CRC值
+ * @param data 数据
+ * @param size 数据大小
+ * @return 更新后的CRC值
+ */
+uint32_t acfs_crc32_update(uint32_t crc, const void* data, size_t size);
+
+/**
+ * 完成递增式CRC32计算
+ * @param crc 当前CRC值
+ * @return 最终CRC32值
+ */
+uint32_t acfs_crc32_finalize(uint32_t crc);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,4 +1,5 @@
 #include "../include/acfs.h"
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -7,13 +8,78 @@ static acfs_error_t acfs_load_header(acfs_t* acfs);
 static acfs_error_t acfs_save_header(acfs_t* acfs);
 static acfs_error_t acfs_load_entries(acfs_t* acfs);
 static acfs_error_t acfs_save_entries(acfs_t* acfs);
+static acfs_error_t acfs_commit_metadata(acfs_t* acfs);
 static acfs_error_t acfs_init_bitmap(acfs_t* acfs);
-static acfs_error_t acfs_allocate_clusters(acfs_t* acfs, uint16_t count, uint16_t* cluster_list);
+static acfs_error_t acfs_allocate_clusters(acfs_t* acfs, uint16_t count, uint16_t* cluster_list, uint16_t owner_slot);
 static void acfs_free_clusters(acfs_t* acfs, uint16_t* cluster_list, uint16_t count);
+static void acfs_set_owner_slot(acfs_t* acfs, uint16_t slot);
 static acfs_data_entry_t* acfs_find_entry(acfs_t* acfs, const char* data_id);
 static uint16_t acfs_calculate_clusters_needed(uint16_t cluster_size, size_t data_size);
-static acfs_error_t acfs_read_clusters(acfs_t* acfs, uint16_t* cluster_list, uint16_t count, void* data);
-static acfs_error_t acfs_write_clusters(acfs_t* acfs, uint16_t* cluster_list, uint16_t count, const void* data);
+static uint16_t acfs_cluster_payload(const acfs_t* acfs);
+static acfs_error_t acfs_read_clusters(acfs_t* acfs, const acfs_data_entry_t* entry, void* data);
+static acfs_error_t acfs_read_range(acfs_t* acfs, const acfs_data_entry_t* entry, uint8_t* data,
+                                    uint16_t first, uint16_t count);
+static acfs_error_t acfs_read_verified(acfs_t* acfs, const acfs_data_entry_t* entry, uint8_t* data);
+static acfs_error_t acfs_write_segments(acfs_t* acfs, const acfs_data_entry_t* entry,
+                                        const acfs_iovec_t* iov, uint16_t iovcnt);
+static acfs_error_t acfs_write_range(acfs_t* acfs, const acfs_data_entry_t* entry,
+                                     const acfs_iovec_t* iov, uint16_t iovcnt, uint16_t first, uint16_t count);
+static bool acfs_pipeline_enabled(const acfs_t* acfs, const acfs_data_entry_t* entry);
+static acfs_error_t acfs_write_pipelined(acfs_t* acfs, acfs_data_entry_t* entry,
+                                         const acfs_iovec_t* iov, uint16_t iovcnt);
+static void acfs_parallel_for(acfs_t* acfs, acfs_task_t task, void* arg, uint32_t count);
+static void acfs_fill_trailer(acfs_t* acfs, const acfs_data_entry_t* entry, uint16_t index,
+                              const uint8_t* payload, acfs_cluster_trailer_t* trailer);
+static acfs_error_t acfs_mark_deleted(acfs_t* acfs, const acfs_data_entry_t* entry);
+static acfs_error_t acfs_restamp_trailers(acfs_t* acfs, const acfs_data_entry_t* entry);
+static acfs_error_t acfs_prepare_entry(acfs_t* acfs, const char* data_id, size_t size, acfs_data_entry_t** out);
+static acfs_error_t acfs_write_cluster(acfs_t* acfs, const acfs_data_entry_t* entry, uint16_t index,
+                                       const uint8_t* chunk, size_t chunk_size);
+static void acfs_ref_clusters(acfs_t* acfs, const uint16_t* cluster_list, uint16_t count);
+static acfs_error_t acfs_resize_clusters(acfs_t* acfs, acfs_data_entry_t* entry, uint16_t count);
+static acfs_reservation_t* acfs_find_reservation(acfs_t* acfs, const char* data_id);
+static const acfs_allocator_t* acfs_allocator(const acfs_t* acfs);
+static uint16_t acfs_group_hint(const acfs_t* acfs, const char* data_id);
+static uint16_t acfs_magazine_take(acfs_t* acfs, uint16_t count, uint16_t* cluster_list);
+static uint16_t acfs_magazine_flush(acfs_t* acfs);
+static acfs_error_t acfs_resize_entry(acfs_t* acfs, const char* data_id, size_t size, bool allow_grow);
+static uint16_t acfs_unref_clusters(acfs_t* acfs, const uint16_t* cluster_list, uint16_t count);
+static bool acfs_entry_shared(const acfs_t* acfs, const acfs_data_entry_t* entry);
+static void acfs_free_snapshot(acfs_t* acfs);
+static acfs_error_t acfs_write_entry(acfs_t* acfs, const char* data_id, const acfs_iovec_t* iov, uint16_t iovcnt,
+                                     uint32_t expire_at);
+static bool acfs_entry_expired(const acfs_t* acfs, const acfs_data_entry_t* entry);
+static void acfs_expiry_push(acfs_t* acfs, uint32_t expire_at, uint16_t slot);
+static acfs_error_t acfs_expiry_rebuild(acfs_t* acfs);
+static acfs_error_t acfs_cache_make_room(acfs_t* acfs, const char* data_id, size_t size);
+static acfs_cached_value_t* acfs_value_cache_alloc(acfs_t* acfs, uint16_t slot, uint32_t size, bool pinned);
+static void acfs_value_cache_drop(acfs_t* acfs, uint16_t slot);
+static acfs_error_t acfs_ring_open(acfs_t* acfs, const acfs_data_entry_t* entry, acfs_ring_cursor_t** out);
+static acfs_error_t acfs_ring_check(acfs_t* acfs, const acfs_data_entry_t* entry);
+static acfs_error_t acfs_unshare_entry(acfs_t* acfs, acfs_data_entry_t* entry);
+static acfs_error_t acfs_find_typed(acfs_t* acfs, const char* data_id, uint8_t type, bool modify,
+                                    acfs_data_entry_t** out);
+static acfs_error_t acfs_queue_load(acfs_t* acfs, const acfs_data_entry_t* entry, acfs_queue_header_t* header);
+static acfs_error_t acfs_queue_store(acfs_t* acfs, const acfs_data_entry_t* entry, acfs_queue_header_t* header);
+static acfs_error_t acfs_queue_take(acfs_t* acfs, const acfs_data_entry_t* entry, acfs_queue_header_t* header,
+                                    uint8_t* data, uint16_t* size);
+static acfs_error_t acfs_queue_resize(acfs_t* acfs, acfs_data_entry_t* entry, uint32_t head_cluster, bool grow);
+static acfs_error_t acfs_queue_check(acfs_t* acfs, const acfs_data_entry_t* entry);
+static acfs_error_t acfs_counter_scan(acfs_t* acfs, const acfs_data_entry_t* entry, acfs_counter_base_t* base,
+                                      uint64_t* value, uint16_t* log_end);
+static acfs_error_t acfs_counter_compact(acfs_t* acfs, const acfs_data_entry_t* entry, acfs_counter_base_t* base,
+                                         uint64_t value);
+static void acfs_log_change(acfs_t* acfs, uint8_t op, const char* data_id, uint8_t type,
+                            uint32_t data_size, uint32_t crc32);
+static acfs_error_t acfs_export_entries(acfs_t* acfs, uint32_t since, bool incremental,
+                                        acfs_stream_write_t write_cb, void* user_data);
+static acfs_error_t acfs_remove_entry(acfs_t* acfs, acfs_data_entry_t* entry);
+static acfs_data_entry_t* acfs_find_tombstone(acfs_t* acfs, const char* data_id);
+static acfs_error_t acfs_purge_tombstone(acfs_t* acfs);
+static acfs_error_t acfs_stream_put(acfs_stream_write_t write_cb, void* user_data,
+                                    const void* data, size_t size, uint32_t* crc);
+static acfs_error_t acfs_stream_get(acfs_stream_read_t read_cb, void* user_data,
+                                    void* data, size_t size, uint32_t* crc);
 
 /**
  * 获取错误描述字符串
@@ -32,6 +98,11 @@ const char* acfs_error_string(acfs_error_t error)
         case ACFS_ERROR_INVALID_FILESYSTEM: return "无效文件系统";
         case ACFS_ERROR_CLUSTER_FULL: return "簇已满";
         case ACFS_ERROR_CRC_MISMATCH: return "CRC校验失败";
+        case ACFS_ERROR_LOG_TRUNCATED: return "变更日志已截断";
+        case ACFS_ERROR_BUSY: return "导出进行中";
+        case ACFS_ERROR_DATA_EXISTS: return "数据已存在";
+        case ACFS_ERROR_VERSION_MISMATCH: return "版本不匹配";
+        case ACFS_ERROR_QUEUE_EMPTY: return "队列为空";
         default: return "未知错误";
     }
 }
@@ -72,6 +143,9 @@ acfs_error_t acfs_init(acfs_t* acfs, storage_device_t* storage, const acfs_confi
                 return ACFS_ERROR_INVALID_FILESYSTEM;
             }
         }
+    } else if (ret == ACFS_ERROR_DATA_CORRUPTED) {
+        // 头部存在但已损坏，不自动格式化，交由acfs_fsck重建
+        return ret;
     } else {
         // 没有找到有效的文件系统，格式化
         if (config->format_if_invalid) {
@@ -96,30 +170,99 @@ acfs_error_t acfs_init(acfs_t* acfs, storage_device_t* storage, const acfs_confi
         return ACFS_ERROR_NO_SPACE;
     }
     
+    acfs->cluster_owner = (acfs_cluster_owner_t*)malloc(acfs->header.total_clusters * sizeof(acfs_cluster_owner_t));
+    if (!acfs->cluster_owner) {
+        free(acfs->entries);
+        free(acfs->cluster_bitmap);
+        return ACFS_ERROR_NO_SPACE;
+    }
+    
+    acfs->cluster_refs = (uint8_t*)malloc(acfs->header.total_clusters);
+    if (!acfs->cluster_refs) {
+        free(acfs->entries);
+        free(acfs->cluster_bitmap);
+        free(acfs->cluster_owner);
+        return ACFS_ERROR_NO_SPACE;
+    }
+    
     acfs->cluster_buffer = (uint8_t*)malloc(acfs->header.cluster_size);
     if (!acfs->cluster_buffer) {
         free(acfs->entries);
         free(acfs->cluster_bitmap);
+        free(acfs->cluster_owner);
+        free(acfs->cluster_refs);
         return ACFS_ERROR_NO_SPACE;
     }
     
     // 加载数据条目和位图
     ret = acfs_load_entries(acfs);
     if (ret != ACFS_OK) {
+        for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
+            free(acfs->entries[i].cluster_list);
+        }
+        acfs_free_snapshot(acfs);
         free(acfs->entries);
         free(acfs->cluster_bitmap);
+        free(acfs->cluster_owner);
+        free(acfs->cluster_refs);
         free(acfs->cluster_buffer);
         return ret;
     }
     
+    // 分配策略在位图建立后挂载
+    acfs->allocator = config->allocator ? config->allocator : &acfs_allocator_extent;
     ret = acfs_init_bitmap(acfs);
     if (ret != ACFS_OK) {
+        for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
+            free(acfs->entries[i].cluster_list);
+        }
+        acfs->allocator->unmount(acfs);
+        acfs_free_snapshot(acfs);
         free(acfs->entries);
         free(acfs->cluster_bitmap);
+        free(acfs->cluster_owner);
+        free(acfs->cluster_refs);
         free(acfs->cluster_buffer);
         return ret;
     }
     
+    // 变更日志只记录挂载之后的变更
+    if (config->change_log_size > 0) {
+        acfs->change_log = (acfs_change_record_t*)calloc(config->change_log_size, sizeof(acfs_change_record_t));
+        if (!acfs->change_log) {
+            for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
+                free(acfs->entries[i].cluster_list);
+            }
+            acfs->allocator->unmount(acfs);
+            acfs_free_snapshot(acfs);
+            free(acfs->entries);
+            free(acfs->cluster_bitmap);
+            free(acfs->cluster_owner);
+            free(acfs->cluster_refs);
+            free(acfs->cluster_buffer);
+            return ACFS_ERROR_NO_SPACE;
+        }
+        acfs->change_log_capacity = config->change_log_size;
+    }
+    acfs->change_log_floor = acfs->header.sequence;
+    
+    // 过期索引在首次回收时建立
+    acfs->get_time = config->get_time;
+    acfs->expiry_dirty = true;
+    
+    // 名称索引和值缓存在首次使用时建立
+    acfs->name_index_dirty = true;
+    acfs->value_cache_size = config->value_cache_size;
+    acfs->value_cache_max_value = config->value_cache_max_value;
+    
+    // 空间预留不持久化，位图重建后预留的簇即为空闲
+    memset(acfs->reservations, 0, sizeof(acfs->reservations));
+    
+    acfs->group_separator = config->group_separator;
+    acfs->group_regions = config->group_regions ? config->group_regions : ACFS_GROUP_REGIONS;
+    acfs->magazine_size = config->magazine_size;
+    acfs->executor = config->executor;
+    
     acfs->initialized = true;
     return ACFS_OK;
 }
@@ -138,6 +281,17 @@ acfs_error_t acfs_deinit(acfs_t* acfs)
     }
     
     // 释放内存
+    if (acfs->value_cache) {
+        for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
+            free(acfs->value_cache[i]);
+        }
+        free(acfs->value_cache);
+    }
+    
+    if (acfs->name_index) {
+        free(acfs->name_index);
+    }
+    
     if (acfs->entries) {
         for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
             if (acfs->entries[i].cluster_list) {
@@ -151,10 +305,30 @@ acfs_error_t acfs_deinit(acfs_t* acfs)
         free(acfs->cluster_bitmap);
     }
     
+    if (acfs->cluster_owner) {
+        free(acfs->cluster_owner);
+    }
+    
+    if (acfs->cluster_refs) {
+        free(acfs->cluster_refs);
+    }
+    
+    acfs->allocator->unmount(acfs);
+    
+    acfs_free_snapshot(acfs);
+    
     if (acfs->cluster_buffer) {
         free(acfs->cluster_buffer);
     }
     
+    if (acfs->change_log) {
+        free(acfs->change_log);
+    }
+    
+    if (acfs->expiry_heap) {
+        free(acfs->expiry_heap);
+    }
+    
     memset(acfs, 0, sizeof(acfs_t));
     return ACFS_OK;
 }
@@ -194,6 +368,10 @@ acfs_error_t acfs_format(acfs_t* acfs, const acfs_config_t* config)
     acfs->header.sys_clusters = sys_clusters;
     acfs->header.data_entries = 0;
     acfs->header.free_clusters = total_clusters - sys_clusters;
+    acfs->header.flags = config->enable_cluster_trailer ? ACFS_FLAG_CLUSTER_TRAILER : 0;
+    if (config->cache_mode) {
+        acfs->header.flags |= ACFS_FLAG_CACHE;
+    }
     
     // 计算头部CRC
     acfs->header.crc32 = acfs_crc32(&acfs->header, sizeof(acfs_header_t) - sizeof(uint32_t));
@@ -227,88 +405,152 @@ acfs_error_t acfs_format(acfs_t* acfs, const acfs_config_t* config)
  */
 acfs_error_t acfs_write(acfs_t* acfs, const char* data_id, const void* data, size_t size)
 {
-    if (!acfs || !data_id || !data || size == 0) {
+    acfs_iovec_t iov = { data, size };
+    return acfs_write_entry(acfs, data_id, &iov, 1, 0);
+}
+
+/**
+ * 分散写入数据
+ */
+acfs_error_t acfs_writev(acfs_t* acfs, const char* data_id, const acfs_iovec_t* iov, uint16_t iovcnt)
+{
+    return acfs_write_entry(acfs, data_id, iov, iovcnt, 0);
+}
+
+/**
+ * 写入带过期时间的数据
+ */
+acfs_error_t acfs_write_ttl(acfs_t* acfs, const char* data_id, const void* data, size_t size, uint32_t ttl)
+{
+    if (!acfs) {
         return ACFS_ERROR_INVALID_PARAM;
     }
     
-    if (!acfs->initialized) {
-        return ACFS_ERROR_NOT_INITIALIZED;
+    acfs_iovec_t iov = { data, size };
+    if (ttl == 0) {
+        return acfs_write_entry(acfs, data_id, &iov, 1, 0);
     }
     
-    if (strlen(data_id) >= ACFS_MAX_DATA_ID_LEN) {
+    if (!acfs->get_time) {
         return ACFS_ERROR_INVALID_PARAM;
     }
     
-    uint16_t clusters_needed = acfs_calculate_clusters_needed(acfs->header.cluster_size, size);
+    return acfs_write_entry(acfs, data_id, &iov, 1, acfs->get_time() + ttl);
+}
+
+/**
+ * 按指定分组写入数据
+ */
+acfs_error_t acfs_write_group(acfs_t* acfs, const char* data_id, const char* group, const void* data, size_t size)
+{
+    if (!acfs || !group) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
     
-    // 查找现有条目
-    acfs_data_entry_t* entry = acfs_find_entry(acfs, data_id);
+    // 分组只在本次写入的簇分配期间生效
+    acfs_iovec_t iov = { data, size };
+    acfs->placement_group = group;
+    acfs_error_t ret = acfs_write_entry(acfs, data_id, &iov, 1, 0);
+    acfs->placement_group = NULL;
+    return ret;
+}
+
+/**
+ * 写入数据并设置过期时间（0表示永不过期）
+ */
+static acfs_error_t acfs_write_entry(acfs_t* acfs, const char* data_id, const acfs_iovec_t* iov, uint16_t iovcnt,
+                                     uint32_t expire_at)
+{
+    if (!acfs || !data_id || !iov) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
     
-    if (entry) {
-        // 更新现有数据
-        if (entry->cluster_count != clusters_needed) {
-            // 重新分配簇
-            acfs_free_clusters(acfs, entry->cluster_list, entry->cluster_count);
-            free(entry->cluster_list);
-            
-            entry->cluster_list = (uint16_t*)malloc(clusters_needed * sizeof(uint16_t));
-            if (!entry->cluster_list) {
-                return ACFS_ERROR_NO_SPACE;
-            }
-            
-            acfs_error_t ret = acfs_allocate_clusters(acfs, clusters_needed, entry->cluster_list);
-            if (ret != ACFS_OK) {
-                free(entry->cluster_list);
-                entry->cluster_list = NULL;
-                return ret;
-            }
-            
-            entry->cluster_count = clusters_needed;
-        }
-    } else {
-        // 创建新条目
-        if (acfs->header.data_entries >= (acfs->header.sys_clusters * acfs->header.cluster_size - sizeof(acfs_header_t)) / sizeof(acfs_data_entry_t)) {
-            return ACFS_ERROR_CLUSTER_FULL;
-        }
-        
-        entry = &acfs->entries[acfs->header.data_entries];
-        strncpy(entry->data_id, data_id, ACFS_MAX_DATA_ID_LEN - 1);
-        entry->data_id[ACFS_MAX_DATA_ID_LEN - 1] = '\0';
-        
-        entry->cluster_list = (uint16_t*)malloc(clusters_needed * sizeof(uint16_t));
-        if (!entry->cluster_list) {
-            return ACFS_ERROR_NO_SPACE;
+    // 各数据段的总大小
+    size_t size = 0;
+    for (uint16_t i = 0; i < iovcnt; i++) {
+        if (iov[i].size > 0 && !iov[i].data) {
+            return ACFS_ERROR_INVALID_PARAM;
         }
-        
-        acfs_error_t ret = acfs_allocate_clusters(acfs, clusters_needed, entry->cluster_list);
+        size += iov[i].size;
+    }
+    
+    if (size == 0) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (strlen(data_id) >= ACFS_MAX_DATA_ID_LEN) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    acfs_error_t ret;
+    if (acfs->header.flags & ACFS_FLAG_CACHE) {
+        ret = acfs_cache_make_room(acfs, data_id, size);
         if (ret != ACFS_OK) {
-            free(entry->cluster_list);
-            entry->cluster_list = NULL;
             return ret;
         }
-        
-        entry->cluster_count = clusters_needed;
-        entry->is_valid = true;
-        acfs->header.data_entries++;
     }
     
-    // 写入数据
+    acfs_data_entry_t* entry;
+    ret = acfs_prepare_entry(acfs, data_id, size, &entry);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    // 写入数据；刚写入的数据视为访问过，缓存模式淘汰时先给一次机会
     entry->data_size = size;
-    entry->crc32 = acfs_crc32(data, size);
+    acfs->header.sequence++;
+    entry->mod_seq = acfs->header.sequence;
+    entry->expire_at = expire_at;
+    entry->referenced = 1;
+    if (expire_at != 0) {
+        acfs_expiry_push(acfs, expire_at, (uint16_t)(entry - acfs->entries));
+    }
     
-    acfs_error_t ret = acfs_write_clusters(acfs, entry->cluster_list, entry->cluster_count, data);
+    if (acfs_pipeline_enabled(acfs, entry)) {
+        // 大数据边计算CRC边写入
+        ret = acfs_write_pipelined(acfs, entry, iov, iovcnt);
+    } else {
+        uint32_t crc = acfs_crc32_init();
+        for (uint16_t i = 0; i < iovcnt; i++) {
+            crc = acfs_crc32_update(crc, iov[i].data, iov[i].size);
+        }
+        entry->crc32 = acfs_crc32_finalize(crc);
+        ret = acfs_write_segments(acfs, entry, iov, iovcnt);
+    }
     if (ret != ACFS_OK) {
         return ret;
     }
     
     // 更新头部和条目表
-    ret = acfs_save_header(acfs);
+    ret = acfs_commit_metadata(acfs);
     if (ret != ACFS_OK) {
         return ret;
     }
     
-    ret = acfs_save_entries(acfs);
-    return ret;
+    // 旧值失效，固定的数据换成新值；缓存不足时固定项保留为过期，读取时重新填入
+    uint16_t slot = (uint16_t)(entry - acfs->entries);
+    if (acfs->value_cache && acfs->value_cache[slot]) {
+        if (acfs->value_cache[slot]->pinned) {
+            acfs_cached_value_t* cached = acfs_value_cache_alloc(acfs, slot, size, true);
+            if (cached) {
+                size_t offset = 0;
+                for (uint16_t i = 0; i < iovcnt; i++) {
+                    memcpy(cached->data + offset, iov[i].data, iov[i].size);
+                    offset += iov[i].size;
+                }
+                cached->mod_seq = entry->mod_seq;
+            }
+        } else {
+            acfs_value_cache_drop(acfs, slot);
+        }
+    }
+    
+    acfs_log_change(acfs, ACFS_CHANGE_WRITE, entry->data_id, entry->type, entry->data_size, entry->crc32);
+    return ACFS_OK;
 }
 
 /**
@@ -325,10 +567,15 @@ acfs_error_t acfs_read(acfs_t* acfs, const char* data_id, void* data, size_t siz
     }
     
     acfs_data_entry_t* entry = acfs_find_entry(acfs, data_id);
-    if (!entry || !entry->is_valid) {
+    if (!entry || !entry->is_valid || acfs_entry_expired(acfs, entry)) {
         return ACFS_ERROR_DATA_NOT_FOUND;
     }
     
+    // 环形记录和队列用各自的接口读取
+    if (entry->type != ACFS_TYPE_VALUE) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
     if (size < entry->data_size) {
         if (actual_size) {
             *actual_size = entry->data_size;
@@ -336,29 +583,62 @@ acfs_error_t acfs_read(acfs_t* acfs, const char* data_id, void* data, size_t siz
         return ACFS_ERROR_INVALID_PARAM;
     }
     
-    // 读取数据
-    acfs_error_t ret = acfs_read_clusters(acfs, entry->cluster_list, entry->cluster_count, data);
-    if (ret != ACFS_OK) {
-        return ret;
-    }
+    uint16_t slot = (uint16_t)(entry - acfs->entries);
+    acfs_cached_value_t* cached = acfs->value_cache ? acfs->value_cache[slot] : NULL;
     
-    // 校验CRC
-    uint32_t crc = acfs_crc32(data, entry->data_size);
-    if (crc != entry->crc32) {
-        return ACFS_ERROR_CRC_MISMATCH;
+    if (cached && cached->mod_seq == entry->mod_seq) {
+        // 缓存命中，缓存的值在填入时已校验
+        memcpy(data, cached->data, entry->data_size);
+    } else {
+        // 读取数据并校验CRC
+        acfs_error_t ret = acfs_read_verified(acfs, entry, (uint8_t*)data);
+        if (ret != ACFS_OK) {
+            return ret;
+        }
+        
+        // 填入缓存；版本过期的固定数据保持固定
+        bool pinned = cached && cached->pinned;
+        if (acfs->value_cache_size > 0 && (pinned || entry->data_size <= acfs->value_cache_max_value)) {
+            cached = acfs_value_cache_alloc(acfs, slot, entry->data_size, pinned);
+            if (cached) {
+                memcpy(cached->data, data, entry->data_size);
+                cached->mod_seq = entry->mod_seq;
+            }
+        }
     }
     
     if (actual_size) {
         *actual_size = entry->data_size;
     }
     
+    entry->referenced = 1;
     return ACFS_OK;
 }
 
 /**
- * 删除数据
+ * 读取数据及其版本号
  */
-acfs_error_t acfs_delete(acfs_t* acfs, const char* data_id)
+acfs_error_t acfs_read_version(acfs_t* acfs, const char* data_id, void* data, size_t size,
+                               size_t* actual_size, uint32_t* version)
+{
+    if (!version) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    acfs_error_t ret = acfs_read(acfs, data_id, data, size, actual_size);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    *version = acfs_find_entry(acfs, data_id)->mod_seq;
+    return ACFS_OK;
+}
+
+/**
+ * 版本号匹配时才写入
+ */
+acfs_error_t acfs_write_if_version(acfs_t* acfs, const char* data_id, uint32_t expected_version,
+                                   const void* data, size_t size, uint32_t* new_version)
 {
     if (!acfs || !data_id) {
         return ACFS_ERROR_INVALID_PARAM;
@@ -368,53 +648,47 @@ acfs_error_t acfs_delete(acfs_t* acfs, const char* data_id)
         return ACFS_ERROR_NOT_INITIALIZED;
     }
     
+    // 不存在的数据（包括删除标记和已过期的数据）版本号为0
     acfs_data_entry_t* entry = acfs_find_entry(acfs, data_id);
-    if (!entry || !entry->is_valid) {
-        return ACFS_ERROR_DATA_NOT_FOUND;
-    }
-    
-    // 释放簇
-    acfs_free_clusters(acfs, entry->cluster_list, entry->cluster_count);
-    free(entry->cluster_list);
-    
-    // 移动其他条目
-    int entry_index = entry - acfs->entries;
-    for (int i = entry_index; i < acfs->header.data_entries - 1; i++) {
-        acfs->entries[i] = acfs->entries[i + 1];
+    uint32_t current_version = (entry && !acfs_entry_expired(acfs, entry)) ? entry->mod_seq : 0;
+    if (current_version != expected_version) {
+        return ACFS_ERROR_VERSION_MISMATCH;
     }
     
-    acfs->header.data_entries--;
-    memset(&acfs->entries[acfs->header.data_entries], 0, sizeof(acfs_data_entry_t));
-    
-    // 保存更改
-    acfs_error_t ret = acfs_save_header(acfs);
+    acfs_error_t ret = acfs_write(acfs, data_id, data, size);
     if (ret != ACFS_OK) {
         return ret;
     }
     
-    ret = acfs_save_entries(acfs);
-    return ret;
+    if (new_version) {
+        *new_version = acfs->header.sequence;
+    }
+    return ACFS_OK;
 }
 
 /**
- * 检查数据是否存在
+ * 截短数据
  */
-bool acfs_exists(acfs_t* acfs, const char* data_id)
+acfs_error_t acfs_truncate(acfs_t* acfs, const char* data_id, size_t size)
 {
-    if (!acfs || !data_id || !acfs->initialized) {
-        return false;
-    }
-    
-    acfs_data_entry_t* entry = acfs_find_entry(acfs, data_id);
-    return (entry && entry->is_valid);
+    return acfs_resize_entry(acfs, data_id, size, false);
 }
 
 /**
- * 获取数据大小
+ * 调整数据大小，增长部分补零
  */
-acfs_error_t acfs_get_size(acfs_t* acfs, const char* data_id, size_t* size)
+acfs_error_t acfs_resize(acfs_t* acfs, const char* data_id, size_t size)
 {
-    if (!acfs || !data_id || !size) {
+    return acfs_resize_entry(acfs, data_id, size, true);
+}
+
+/**
+ * 调整数据大小：只改写变化的尾部簇，保留的簇不搬移
+ * 增长时由原CRC接着计算补零部分；缩短时读取保留的数据重新计算CRC。
+ */
+static acfs_error_t acfs_resize_entry(acfs_t* acfs, const char* data_id, size_t size, bool allow_grow)
+{
+    if (!acfs || !data_id || size == 0) {
         return ACFS_ERROR_INVALID_PARAM;
     }
     
@@ -422,326 +696,4760 @@ acfs_error_t acfs_get_size(acfs_t* acfs, const char* data_id, size_t* size)
         return ACFS_ERROR_NOT_INITIALIZED;
     }
     
-    acfs_data_entry_t* entry = acfs_find_entry(acfs, data_id);
-    if (!entry || !entry->is_valid) {
-        return ACFS_ERROR_DATA_NOT_FOUND;
+    acfs_error_t ret;
+    if (allow_grow && (acfs->header.flags & ACFS_FLAG_CACHE)) {
+        ret = acfs_cache_make_room(acfs, data_id, size);
+        if (ret != ACFS_OK) {
+            return ret;
+        }
     }
     
-    *size = entry->data_size;
-    return ACFS_OK;
-}
-
-/**
- * 获取空闲空间
- */
-acfs_error_t acfs_get_free_space(acfs_t* acfs, size_t* free_size)
-{
-    if (!acfs || !free_size) {
-        return ACFS_ERROR_INVALID_PARAM;
+    acfs_data_entry_t* entry;
+    ret = acfs_find_typed(acfs, data_id, ACFS_TYPE_VALUE, true, &entry);
+    if (ret != ACFS_OK) {
+        return ret;
     }
     
-    if (!acfs->initialized) {
-        return ACFS_ERROR_NOT_INITIALIZED;
+    size_t old_size = entry->data_size;
+    if (size == old_size) {
+        return ACFS_OK;
     }
     
-    *free_size = (size_t)acfs->header.free_clusters * acfs->header.cluster_size;
-    return ACFS_OK;
-}
-
-/**
- * 获取系统统计信息
- */
-acfs_error_t acfs_get_stats(acfs_t* acfs, size_t* total_size, size_t* used_size, 
-                           size_t* free_size, uint16_t* data_count)
-{
-    if (!acfs) {
+    if (size > old_size && !allow_grow) {
         return ACFS_ERROR_INVALID_PARAM;
     }
     
-    if (!acfs->initialized) {
-        return ACFS_ERROR_NOT_INITIALIZED;
+    uint16_t payload = acfs_cluster_payload(acfs);
+    uint32_t crc;
+    if (size > old_size) {
+        // 已结束的CRC取反即为中间状态
+        crc = acfs_crc32_finalize(entry->crc32);
+        memset(acfs->cluster_buffer, 0, payload);
+        for (size_t done = old_size; done < size; ) {
+            size_t chunk = size - done < payload ? size - done : payload;
+            crc = acfs_crc32_update(crc, acfs->cluster_buffer, chunk);
+            done += chunk;
+        }
+    } else {
+        // 读出全部旧数据：先校验旧值，再由保留的部分算出新CRC，避免把损坏的数据变成有效值
+        uint32_t old_crc = acfs_crc32_init();
+        crc = acfs_crc32_init();
+        for (uint16_t i = 0; (size_t)i * payload < old_size; i++) {
+            size_t offset = (size_t)i * payload;
+            size_t chunk = old_size - offset < payload ? old_size - offset : payload;
+            uint32_t addr = acfs->storage->start_addr + entry->cluster_list[i] * acfs->header.cluster_size;
+            if (acfs->storage->ops.read(addr, acfs->cluster_buffer, chunk) != 0) {
+                return ACFS_ERROR_IO_ERROR;
+            }
+            old_crc = acfs_crc32_update(old_crc, acfs->cluster_buffer, chunk);
+            if (offset < size) {
+                crc = acfs_crc32_update(crc, acfs->cluster_buffer, size - offset < chunk ? size - offset : chunk);
+            }
+        }
+        if (acfs_crc32_finalize(old_crc) != entry->crc32) {
+            return ACFS_ERROR_CRC_MISMATCH;
+        }
     }
     
-    size_t data_area_size = (size_t)(acfs->header.total_clusters - acfs->header.sys_clusters) * acfs->header.cluster_size;
+    uint16_t old_count = entry->cluster_count;
+    uint16_t new_count = acfs_calculate_clusters_needed(payload, size);
+    ret = acfs_resize_clusters(acfs, entry, new_count);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
     
-    if (total_size) {
-        *total_size = data_area_size;
+    entry->data_size = size;
+    entry->crc32 = acfs_crc32_finalize(crc);
+    acfs->header.sequence++;
+    entry->mod_seq = acfs->header.sequence;
+    
+    // 保留的末簇：缩短时清零截掉的部分，启用簇尾部时更新尾部
+    uint16_t last = (old_count < new_count ? old_count : new_count) - 1;
+    size_t kept = (size < old_size ? size : old_size) - (size_t)last * payload;
+    if ((acfs->header.flags & ACFS_FLAG_CLUSTER_TRAILER) || (size < old_size && kept < payload)) {
+        uint32_t addr = acfs->storage->start_addr + entry->cluster_list[last] * acfs->header.cluster_size;
+        if (acfs->storage->ops.read(addr, acfs->cluster_buffer, kept) != 0) {
+            return ACFS_ERROR_IO_ERROR;
+        }
+        ret = acfs_write_cluster(acfs, entry, last, acfs->cluster_buffer, kept);
+        if (ret != ACFS_OK) {
+            return ret;
+        }
     }
     
-    if (free_size) {
-        *free_size = (size_t)acfs->header.free_clusters * acfs->header.cluster_size;
+    // 新增的簇写零
+    for (uint16_t i = old_count; i < new_count; i++) {
+        size_t chunk = size - (size_t)i * payload < payload ? size - (size_t)i * payload : payload;
+        memset(acfs->cluster_buffer, 0, chunk);
+        ret = acfs_write_cluster(acfs, entry, i, acfs->cluster_buffer, chunk);
+        if (ret != ACFS_OK) {
+            return ret;
+        }
     }
     
-    if (used_size) {
-        *used_size = data_area_size - ((size_t)acfs->header.free_clusters * acfs->header.cluster_size);
+    ret = acfs_commit_metadata(acfs);
+    if (ret != ACFS_OK) {
+        return ret;
     }
     
-    if (data_count) {
-        *data_count = acfs->header.data_entries;
+    // 固定的数据重新载入新值
+    uint16_t slot = (uint16_t)(entry - acfs->entries);
+    if (acfs->value_cache && acfs->value_cache[slot]) {
+        bool pinned = acfs->value_cache[slot]->pinned;
+        acfs_value_cache_drop(acfs, slot);
+        if (pinned) {
+            acfs_pin(acfs, data_id);
+        }
     }
     
+    acfs_log_change(acfs, ACFS_CHANGE_WRITE, entry->data_id, entry->type, entry->data_size, entry->crc32);
     return ACFS_OK;
 }
 
-/* 内部函数实现 */
-
-static acfs_error_t acfs_load_header(acfs_t* acfs)
+/**
+ * 删除数据
+ */
+acfs_error_t acfs_delete(acfs_t* acfs, const char* data_id)
 {
-    uint32_t addr = acfs->storage->start_addr;
-    if (acfs->storage->ops.read(addr, &acfs->header, sizeof(acfs_header_t)) != 0) {
-        return ACFS_ERROR_IO_ERROR;
+    if (!acfs || !data_id) {
+        return ACFS_ERROR_INVALID_PARAM;
     }
     
-    // 验证魔数
-    if (acfs->header.magic != ACFS_MAGIC_NUMBER) {
-        return ACFS_ERROR_INVALID_FILESYSTEM;
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
     }
     
-    // 验证CRC
-    uint32_t crc = acfs_crc32(&acfs->header, sizeof(acfs_header_t) - sizeof(uint32_t));
-    if (crc != acfs->header.crc32) {
-        return ACFS_ERROR_DATA_CORRUPTED;
+    acfs_data_entry_t* entry = acfs_find_entry(acfs, data_id);
+    if (!entry || !entry->is_valid || acfs_entry_expired(acfs, entry)) {
+        return ACFS_ERROR_DATA_NOT_FOUND;
     }
     
-    return ACFS_OK;
-}
-
-static acfs_error_t acfs_save_header(acfs_t* acfs)
-{
-    acfs->header.crc32 = acfs_crc32(&acfs->header, sizeof(acfs_header_t) - sizeof(uint32_t));
+    acfs->header.sequence++;
+    acfs_error_t ret = acfs_remove_entry(acfs, entry);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
     
-    uint32_t addr = acfs->storage->start_addr;
-    if (acfs->storage->ops.write(addr, &acfs->header, sizeof(acfs_header_t)) != 0) {
-        return ACFS_ERROR_IO_ERROR;
+    // 保存更改
+    ret = acfs_commit_metadata(acfs);
+    if (ret != ACFS_OK) {
+        return ret;
     }
     
+    acfs_log_change(acfs, ACFS_CHANGE_DELETE, entry->data_id, entry->type, 0, 0);
     return ACFS_OK;
 }
 
-static acfs_error_t acfs_load_entries(acfs_t* acfs)
+/**
+ * 重命名数据
+ */
+acfs_error_t acfs_rename(acfs_t* acfs, const char* old_id, const char* new_id, bool replace_existing)
 {
-    uint32_t entries_addr = acfs->storage->start_addr + sizeof(acfs_header_t);
-    uint32_t entries_size = acfs->header.data_entries * sizeof(acfs_data_entry_t);
+    if (!acfs || !old_id || !new_id) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (new_id[0] == '\0' || strlen(new_id) >= ACFS_MAX_DATA_ID_LEN) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    acfs_data_entry_t* source = acfs_find_entry(acfs, old_id);
+    if (!source || acfs_entry_expired(acfs, source)) {
+        return ACFS_ERROR_DATA_NOT_FOUND;
+    }
     
-    if (entries_size == 0) {
+    if (strcmp(old_id, new_id) == 0) {
         return ACFS_OK;
     }
     
-    // 读取条目数据（不包括簇列表）
-    if (acfs->storage->ops.read(entries_addr, acfs->entries, entries_size) != 0) {
-        return ACFS_ERROR_IO_ERROR;
+    // 标识可能指向条目表内部（如acfs_foreach回调的参数），先复制
+    char old_name[ACFS_MAX_DATA_ID_LEN];
+    char new_name[ACFS_MAX_DATA_ID_LEN];
+    memset(old_name, 0, ACFS_MAX_DATA_ID_LEN);
+    memset(new_name, 0, ACFS_MAX_DATA_ID_LEN);
+    strncpy(old_name, old_id, ACFS_MAX_DATA_ID_LEN - 1);
+    strncpy(new_name, new_id, ACFS_MAX_DATA_ID_LEN - 1);
+    
+    // 已过期的同名条目视为不存在，直接替换
+    acfs_data_entry_t* target = acfs_find_entry(acfs, new_name);
+    if (target && !replace_existing && !acfs_entry_expired(acfs, target)) {
+        return ACFS_ERROR_DATA_EXISTS;
     }
     
-    // 为每个条目分配和读取簇列表
-    for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
-        acfs_data_entry_t* entry = &acfs->entries[i];
-        
-        if (entry->cluster_count > 0) {
-            entry->cluster_list = (uint16_t*)malloc(entry->cluster_count * sizeof(uint16_t));
-            if (!entry->cluster_list) {
-                return ACFS_ERROR_NO_SPACE;
-            }
-            
-            // 从存储中读取簇列表（存储在条目数据之后）
-            uint32_t cluster_list_addr = entries_addr + entries_size + i * ACFS_MAX_CLUSTERS * sizeof(uint16_t);
-            if (acfs->storage->ops.read(cluster_list_addr, entry->cluster_list, 
-                                       entry->cluster_count * sizeof(uint16_t)) != 0) {
-                return ACFS_ERROR_IO_ERROR;
-            }
+    acfs->header.sequence++;
+    
+    // 被替换的条目转为删除标记，其槽位随后存放改名后的条目
+    if (target) {
+        acfs_error_t ret = acfs_remove_entry(acfs, target);
+        if (ret != ACFS_OK) {
+            return ret;
+        }
+    }
+    
+    // 改名后的条目移入新槽位，原槽位成为旧名称的删除标记
+    uint16_t max_entries = (acfs->header.sys_clusters * acfs->header.cluster_size - sizeof(acfs_header_t)) / sizeof(acfs_data_entry_t);
+    acfs_data_entry_t* slot = acfs_find_tombstone(acfs, new_name);
+    if (!slot && acfs->header.data_entries >= max_entries && acfs_purge_tombstone(acfs) == ACFS_OK) {
+        slot = &acfs->entries[acfs->header.data_entries++];
+    } else if (!slot && acfs->header.data_entries < max_entries) {
+        slot = &acfs->entries[acfs->header.data_entries++];
+    }
+    
+    // 清除删除标记会移动条目，重新查找
+    acfs_data_entry_t* entry = acfs_find_entry(acfs, old_name);
+    
+    if (slot) {
+        *slot = *entry;
+        acfs_set_owner_slot(acfs, (uint16_t)(slot - acfs->entries));
+        acfs->expiry_dirty = true;
+        if (acfs->value_cache) {
+            acfs->value_cache[slot - acfs->entries] = acfs->value_cache[entry - acfs->entries];
+            acfs->value_cache[entry - acfs->entries] = NULL;
         }
+        
+        entry->cluster_list = NULL;
+        entry->cluster_count = 0;
+        entry->data_size = 0;
+        entry->crc32 = 0;
+        entry->mod_seq = acfs->header.sequence;
+        entry->expire_at = 0;
+        entry->is_valid = false;
+        entry = slot;
+    } else {
+        // 条目表已满且没有删除标记可清除：原地改名，旧名称的删除无法增量导出
+        acfs->header.tombstone_floor = acfs->header.sequence;
+    }
+    
+    memcpy(entry->data_id, new_name, ACFS_MAX_DATA_ID_LEN);
+    entry->mod_seq = acfs->header.sequence;
+    acfs->name_index_dirty = true;
+    
+    // 数据未变，缓存的值和固定状态随条目转移
+    if (acfs->value_cache && acfs->value_cache[entry - acfs->entries]) {
+        acfs->value_cache[entry - acfs->entries]->mod_seq = entry->mod_seq;
+    }
+    
+    acfs_error_t ret = acfs_commit_metadata(acfs);
+    if (ret != ACFS_OK) {
+        return ret;
     }
     
+    acfs_log_change(acfs, ACFS_CHANGE_DELETE, old_name, entry->type, 0, 0);
+    acfs_log_change(acfs, ACFS_CHANGE_WRITE, entry->data_id, entry->type, entry->data_size, entry->crc32);
     return ACFS_OK;
 }
 
-static acfs_error_t acfs_save_entries(acfs_t* acfs)
+/**
+ * 检查数据是否存在
+ */
+bool acfs_exists(acfs_t* acfs, const char* data_id)
 {
-    uint32_t entries_addr = acfs->storage->start_addr + sizeof(acfs_header_t);
-    uint32_t entries_size = acfs->header.data_entries * sizeof(acfs_data_entry_t);
+    if (!acfs || !data_id || !acfs->initialized) {
+        return false;
+    }
     
-    // 写入条目数据（不包括簇列表）
-    if (acfs->storage->ops.write(entries_addr, acfs->entries, entries_size) != 0) {
-        return ACFS_ERROR_IO_ERROR;
+    acfs_data_entry_t* entry = acfs_find_entry(acfs, data_id);
+    return (entry && entry->is_valid && !acfs_entry_expired(acfs, entry));
+}
+
+/**
+ * 遍历所有数据条目
+ */
+acfs_error_t acfs_foreach(acfs_t* acfs, acfs_foreach_callback_t callback, void* user_data)
+{
+    if (!acfs || !callback) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
     }
     
-    // 写入每个条目的簇列表
     for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
         acfs_data_entry_t* entry = &acfs->entries[i];
+        if (!entry->is_valid || acfs_entry_expired(acfs, entry)) {
+            continue;
+        }
         
-        if (entry->cluster_count > 0 && entry->cluster_list) {
-            uint32_t cluster_list_addr = entries_addr + entries_size + i * ACFS_MAX_CLUSTERS * sizeof(uint16_t);
-            if (acfs->storage->ops.write(cluster_list_addr, entry->cluster_list, 
-                                        entry->cluster_count * sizeof(uint16_t)) != 0) {
-                return ACFS_ERROR_IO_ERROR;
-            }
+        acfs_error_t ret = callback(entry->data_id, entry->data_size, user_data);
+        if (ret != ACFS_OK) {
+            return ret;
         }
     }
     
     return ACFS_OK;
 }
 
-static acfs_error_t acfs_init_bitmap(acfs_t* acfs)
+/**
+ * 获取数据大小
+ */
+acfs_error_t acfs_get_size(acfs_t* acfs, const char* data_id, size_t* size)
 {
-    size_t bitmap_size = (acfs->header.total_clusters + 7) / 8;
-    memset(acfs->cluster_bitmap, 0, bitmap_size);
+    if (!acfs || !data_id || !size) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
     
-    // 标记系统簇为已使用
-    for (uint16_t i = 0; i < acfs->header.sys_clusters; i++) {
-        uint16_t byte_idx = i / 8;
-        uint8_t bit_idx = i % 8;
-        acfs->cluster_bitmap[byte_idx] |= (1 << bit_idx);
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
     }
     
-    // 标记数据簇为已使用
-    for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
-        acfs_data_entry_t* entry = &acfs->entries[i];
-        if (entry->is_valid && entry->cluster_list) {
-            for (uint16_t j = 0; j < entry->cluster_count; j++) {
-                uint16_t cluster = entry->cluster_list[j];
-                uint16_t byte_idx = cluster / 8;
-                uint8_t bit_idx = cluster % 8;
-                acfs->cluster_bitmap[byte_idx] |= (1 << bit_idx);
-            }
-        }
+    acfs_data_entry_t* entry = acfs_find_entry(acfs, data_id);
+    if (!entry || !entry->is_valid || acfs_entry_expired(acfs, entry)) {
+        return ACFS_ERROR_DATA_NOT_FOUND;
     }
     
+    *size = entry->data_size;
     return ACFS_OK;
 }
 
-static acfs_error_t acfs_allocate_clusters(acfs_t* acfs, uint16_t count, uint16_t* cluster_list)
+/**
+ * 获取条目元数据
+ */
+acfs_error_t acfs_stat(acfs_t* acfs, const char* data_id, acfs_stat_t* info)
 {
-    if (acfs->header.free_clusters < count) {
-        return ACFS_ERROR_NO_SPACE;
+    if (!acfs || !data_id || !info) {
+        return ACFS_ERROR_INVALID_PARAM;
     }
     
-    uint16_t allocated = 0;
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
     
-    for (uint16_t i = acfs->header.sys_clusters; i < acfs->header.total_clusters && allocated < count; i++) {
-        uint16_t byte_idx = i / 8;
-        uint8_t bit_idx = i % 8;
-        
-        if (!(acfs->cluster_bitmap[byte_idx] & (1 << bit_idx))) {
-            // 标记为已使用
-            acfs->cluster_bitmap[byte_idx] |= (1 << bit_idx);
-            cluster_list[allocated++] = i;
-        }
+    acfs_data_entry_t* entry = acfs_find_entry(acfs, data_id);
+    if (!entry || !entry->is_valid || acfs_entry_expired(acfs, entry)) {
+        return ACFS_ERROR_DATA_NOT_FOUND;
     }
     
-    if (allocated < count) {
-        // 回滚已分配的簇
-        for (uint16_t i = 0; i < allocated; i++) {
-            uint16_t cluster = cluster_list[i];
-            uint16_t byte_idx = cluster / 8;
-            uint8_t bit_idx = cluster % 8;
-            acfs->cluster_bitmap[byte_idx] &= ~(1 << bit_idx);
+    memset(info, 0, sizeof(*info));
+    info->size = entry->data_size;
+    info->crc32 = entry->crc32;
+    info->version = entry->mod_seq;
+    info->expire_at = entry->expire_at;
+    info->cluster_count = entry->cluster_count;
+    info->type = entry->type;
+    
+    for (uint16_t i = 0; i < entry->cluster_count; i++) {
+        if (i == 0 || entry->cluster_list[i] != entry->cluster_list[i - 1] + 1) {
+            info->extent_count++;
         }
-        return ACFS_ERROR_NO_SPACE;
     }
     
-    acfs->header.free_clusters -= count;
+    uint16_t slot = (uint16_t)(entry - acfs->entries);
+    acfs_cached_value_t* cached = acfs->value_cache ? acfs->value_cache[slot] : NULL;
+    info->pinned = cached && cached->pinned;
     return ACFS_OK;
 }
 
-static void acfs_free_clusters(acfs_t* acfs, uint16_t* cluster_list, uint16_t count)
+/**
+ * 批量获取条目元数据
+ */
+acfs_error_t acfs_stat_batch(acfs_t* acfs, const char* const* data_ids, uint16_t count,
+                             acfs_stat_t* infos, acfs_error_t* results, uint16_t* found)
 {
-    for (uint16_t i = 0; i < count; i++) {
-        uint16_t cluster = cluster_list[i];
-        uint16_t byte_idx = cluster / 8;
-        uint8_t bit_idx = cluster % 8;
-        acfs->cluster_bitmap[byte_idx] &= ~(1 << bit_idx);
+    if (!acfs || !data_ids || !infos) {
+        return ACFS_ERROR_INVALID_PARAM;
     }
     
-    acfs->header.free_clusters += count;
-}
-
-static acfs_data_entry_t* acfs_find_entry(acfs_t* acfs, const char* data_id)
-{
-    for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
-        if (acfs->entries[i].is_valid && 
-            strncmp(acfs->entries[i].data_id, data_id, ACFS_MAX_DATA_ID_LEN) == 0) {
-            return &acfs->entries[i];
-        }
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
     }
-    return NULL;
-}
-
-static uint16_t acfs_calculate_clusters_needed(uint16_t cluster_size, size_t data_size)
-{
-    return (data_size + cluster_size - 1) / cluster_size;
-}
-
-static acfs_error_t acfs_read_clusters(acfs_t* acfs, uint16_t* cluster_list, uint16_t count, void* data)
-{
-    uint8_t* data_ptr = (uint8_t*)data;
     
+    uint16_t hits = 0;
     for (uint16_t i = 0; i < count; i++) {
-        uint32_t addr = acfs->storage->start_addr + cluster_list[i] * acfs->header.cluster_size;
-        if (acfs->storage->ops.read(addr, data_ptr, acfs->header.cluster_size) != 0) {
-            return ACFS_ERROR_IO_ERROR;
+        acfs_error_t ret = data_ids[i] ? acfs_stat(acfs, data_ids[i], &infos[i]) : ACFS_ERROR_INVALID_PARAM;
+        if (ret == ACFS_OK) {
+            hits++;
+        } else {
+            memset(&infos[i], 0, sizeof(infos[i]));
+        }
+        if (results) {
+            results[i] = ret;
         }
-        data_ptr += acfs->header.cluster_size;
     }
     
+    if (found) {
+        *found = hits;
+    }
     return ACFS_OK;
 }
 
-static acfs_error_t acfs_write_clusters(acfs_t* acfs, uint16_t* cluster_list, uint16_t count, const void* data)
+/**
+ * 获取空闲空间
+ */
+acfs_error_t acfs_get_free_space(acfs_t* acfs, size_t* free_size)
 {
-    const uint8_t* data_ptr = (const uint8_t*)data;
+    if (!acfs || !free_size) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
     
-    for (uint16_t i = 0; i < count; i++) {
-        uint32_t addr = acfs->storage->start_addr + cluster_list[i] * acfs->header.cluster_size;
-        if (acfs->storage->ops.write(addr, data_ptr, acfs->header.cluster_size) != 0) {
-            return ACFS_ERROR_IO_ERROR;
-        }
-        data_ptr += acfs->header.cluster_size;
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
     }
     
+    *free_size = (size_t)acfs->header.free_clusters * acfs->header.cluster_size;
     return ACFS_OK;
 }
 
-acfs_error_t acfs_check_integrity(acfs_t* acfs)
+/**
+ * 获取簇分配策略的空闲段统计
+ */
+acfs_error_t acfs_get_alloc_stats(acfs_t* acfs, acfs_alloc_stats_t* stats)
 {
-    if (!acfs || !acfs->initialized) {
-        return ACFS_ERROR_NOT_INITIALIZED;
+    if (!acfs || !stats) {
+        return ACFS_ERROR_INVALID_PARAM;
     }
-    
-    // 检查每个数据条目的CRC
-    for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
-        acfs_data_entry_t* entry = &acfs->entries[i];
-        if (!entry->is_valid) continue;
-        
-        // 读取数据
-        uint8_t* temp_data = (uint8_t*)malloc(entry->data_size);
-        if (!temp_data) {
-            return ACFS_ERROR_NO_SPACE;
-        }
-        
-        acfs_error_t ret = acfs_read_clusters(acfs, entry->cluster_list, entry->cluster_count, temp_data);
-        if (ret != ACFS_OK) {
-            free(temp_data);
-            return ret;
-        }
-        
-        // 验证CRC
-        uint32_t crc = acfs_crc32(temp_data, entry->data_size);
-        free(temp_data);
-        
-        if (crc != entry->crc32) {
-            return ACFS_ERROR_DATA_CORRUPTED;
-        }
+
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
     }
-    
+
+    memset(stats, 0, sizeof(acfs_alloc_stats_t));
+    acfs->allocator->stats(acfs, stats);
+    stats->free_clusters += acfs->magazine.remaining;
     return ACFS_OK;
 }
 
-acfs_error_t acfs_defragment(acfs_t* acfs)
+/**
+ * 获取系统统计信息
+ */
+acfs_error_t acfs_get_stats(acfs_t* acfs, size_t* total_size, size_t* used_size, 
+                           size_t* free_size, uint16_t* data_count)
 {
-    // 简单的碎片整理实现：重新分配连续的簇
-    if (!acfs || !acfs->initialized) {
+    if (!acfs) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
         return ACFS_ERROR_NOT_INITIALIZED;
     }
     
-    // TODO: 实现更复杂的碎片整理算法
-    return ACFS_OK;
-} 
\ No newline at end of file
+    size_t data_area_size = (size_t)(acfs->header.total_clusters - acfs->header.sys_clusters) * acfs->header.cluster_size;
+    
+    if (total_size) {
+        *total_size = data_area_size;
+    }
+    
+    if (free_size) {
+        *free_size = (size_t)acfs->header.free_clusters * acfs->header.cluster_size;
+    }
+    
+    if (used_size) {
+        *used_size = data_area_size - ((size_t)acfs->header.free_clusters * acfs->header.cluster_size);
+    }
+    
+    if (data_count) {
+        // 删除标记和已过期的数据不计入
+        *data_count = 0;
+        for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
+            if (acfs->entries[i].is_valid && !acfs_entry_expired(acfs, &acfs->entries[i])) {
+                (*data_count)++;
+            }
+        }
+    }
+    
+    return ACFS_OK;
+}
+
+/**
+ * 回放变更日志
+ */
+acfs_error_t acfs_changes_since(acfs_t* acfs, uint32_t sequence, acfs_change_callback_t callback, void* user_data)
+{
+    if (!acfs || !callback) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (sequence >= acfs->header.sequence) {
+        return ACFS_OK;
+    }
+    
+    // 请求的起点之后有变更已不在日志中
+    if (sequence < acfs->change_log_floor) {
+        return ACFS_ERROR_LOG_TRUNCATED;
+    }
+    
+    for (uint16_t i = 0; i < acfs->change_log_count; i++) {
+        const acfs_change_record_t* record = 
+            &acfs->change_log[(acfs->change_log_head + i) % acfs->change_log_capacity];
+        if (record->sequence <= sequence) {
+            continue;
+        }
+        
+        acfs_error_t ret = callback(record, user_data);
+        if (ret != ACFS_OK) {
+            return ret;
+        }
+    }
+    
+    return ACFS_OK;
+}
+
+/**
+ * 获取当前写入序列号
+ */
+acfs_error_t acfs_get_sequence(acfs_t* acfs, uint32_t* sequence)
+{
+    if (!acfs || !sequence) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    *sequence = acfs->header.sequence;
+    return ACFS_OK;
+}
+
+/**
+ * 创建卷快照
+ */
+acfs_error_t acfs_snapshot_create(acfs_t* acfs)
+{
+    if (!acfs) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
+        if (acfs->entries[i].is_valid && !acfs_entry_expired(acfs, &acfs->entries[i])) {
+            count++;
+        }
+    }
+    
+    acfs_data_entry_t* snapshot = (acfs_data_entry_t*)calloc(count ? count : 1, sizeof(acfs_data_entry_t));
+    if (!snapshot) {
+        return ACFS_ERROR_NO_SPACE;
+    }
+    
+    // 只复制条目表，删除标记和已过期的数据不进入快照
+    uint16_t taken = 0;
+    for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
+        const acfs_data_entry_t* entry = &acfs->entries[i];
+        if (!entry->is_valid || acfs_entry_expired(acfs, entry)) {
+            continue;
+        }
+        
+        snapshot[taken] = *entry;
+        snapshot[taken].cluster_list = (uint16_t*)malloc((entry->cluster_count ? entry->cluster_count : 1) * sizeof(uint16_t));
+        if (!snapshot[taken].cluster_list) {
+            for (uint16_t j = 0; j < taken; j++) {
+                free(snapshot[j].cluster_list);
+            }
+            free(snapshot);
+            return ACFS_ERROR_NO_SPACE;
+        }
+        if (entry->cluster_count > 0) {
+            memcpy(snapshot[taken].cluster_list, entry->cluster_list, entry->cluster_count * sizeof(uint16_t));
+        }
+        taken++;
+    }
+    
+    for (uint16_t i = 0; i < taken; i++) {
+        acfs_ref_clusters(acfs, snapshot[i].cluster_list, snapshot[i].cluster_count);
+    }
+    
+    // 替换旧快照，元数据写入失败时恢复
+    acfs_data_entry_t* old_snapshot = acfs->snapshot;
+    uint16_t old_count = acfs->header.snapshot_entries;
+    uint16_t old_flags = acfs->header.flags;
+    
+    acfs->snapshot = snapshot;
+    acfs->header.snapshot_entries = taken;
+    acfs->header.flags |= ACFS_FLAG_SNAPSHOT;
+    
+    acfs_error_t ret = acfs_commit_metadata(acfs);
+    if (ret != ACFS_OK) {
+        for (uint16_t i = 0; i < taken; i++) {
+            acfs_unref_clusters(acfs, snapshot[i].cluster_list, snapshot[i].cluster_count);
+        }
+        acfs_free_snapshot(acfs);
+        acfs->snapshot = old_snapshot;
+        acfs->header.snapshot_entries = old_count;
+        acfs->header.flags = old_flags;
+        return ret;
+    }
+    
+    // 回收只被旧快照引用的簇
+    if (old_snapshot) {
+        uint16_t freed = 0;
+        for (uint16_t i = 0; i < old_count; i++) {
+            freed += acfs_unref_clusters(acfs, old_snapshot[i].cluster_list, old_snapshot[i].cluster_count);
+            free(old_snapshot[i].cluster_list);
+        }
+        free(old_snapshot);
+        
+        if (freed > 0) {
+            ret = acfs_save_header(acfs);
+        }
+    }
+    
+    return ret;
+}
+
+/**
+ * 回滚到卷快照
+ */
+acfs_error_t acfs_snapshot_restore(acfs_t* acfs)
+{
+    if (!acfs) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (!(acfs->header.flags & ACFS_FLAG_SNAPSHOT)) {
+        return ACFS_ERROR_DATA_NOT_FOUND;
+    }
+    
+    // 先复制全部簇列表并分配暂存的条目表，之后的步骤不再分配内存
+    uint16_t count = acfs->header.snapshot_entries;
+    uint16_t max_entries = (acfs->header.sys_clusters * acfs->header.cluster_size - sizeof(acfs_header_t)) / sizeof(acfs_data_entry_t);
+    uint16_t** lists = (uint16_t**)calloc(count ? count : 1, sizeof(uint16_t*));
+    acfs_data_entry_t* staged = (acfs_data_entry_t*)malloc(max_entries * sizeof(acfs_data_entry_t));
+    uint16_t* from = (uint16_t*)malloc(max_entries * sizeof(uint16_t));
+    if (!lists || !staged || !from) {
+        free(lists);
+        free(staged);
+        free(from);
+        return ACFS_ERROR_NO_SPACE;
+    }
+    
+    acfs_error_t ret = ACFS_OK;
+    for (uint16_t i = 0; i < count; i++) {
+        const acfs_data_entry_t* snap = &acfs->snapshot[i];
+        lists[i] = (uint16_t*)malloc((snap->cluster_count ? snap->cluster_count : 1) * sizeof(uint16_t));
+        if (!lists[i]) {
+            ret = ACFS_ERROR_NO_SPACE;
+            goto cleanup;
+        }
+        if (snap->cluster_count > 0) {
+            memcpy(lists[i], snap->cluster_list, snap->cluster_count * sizeof(uint16_t));
+        }
+    }
+    
+    // 在暂存的条目表上完成回滚，提交成功后才替换内存中的条目表
+    uint32_t old_sequence = acfs->header.sequence;
+    uint32_t old_floor = acfs->header.tombstone_floor;
+    uint16_t old_free = acfs->header.free_clusters;
+    uint16_t old_count = acfs->header.data_entries;
+    acfs_data_entry_t* old_entries = acfs->entries;
+    
+    acfs->header.sequence++;
+    uint16_t n = old_count;
+    memcpy(staged, old_entries, old_count * sizeof(acfs_data_entry_t));
+    for (uint16_t i = 0; i < old_count; i++) {
+        from[i] = i;
+    }
+    
+    // 快照中没有的条目转为删除标记；被释放的簇数用于提交的头部
+    uint16_t freed = 0;
+    for (uint16_t i = 0; i < old_count; i++) {
+        acfs_data_entry_t* entry = &staged[i];
+        if (!entry->is_valid) {
+            continue;
+        }
+        
+        for (uint16_t k = 0; k < entry->cluster_count; k++) {
+            freed += (acfs->cluster_refs[entry->cluster_list[k]] == 1);
+        }
+        
+        bool in_snapshot = false;
+        for (uint16_t j = 0; j < count && !in_snapshot; j++) {
+            in_snapshot = (strcmp(acfs->snapshot[j].data_id, entry->data_id) == 0);
+        }
+        if (in_snapshot) {
+            continue;
+        }
+        
+        entry->cluster_list = NULL;
+        entry->cluster_count = 0;
+        entry->data_size = 0;
+        entry->crc32 = 0;
+        entry->mod_seq = acfs->header.sequence;
+        entry->expire_at = 0;
+        entry->referenced = 0;
+        entry->is_valid = false;
+    }
+    
+    // 其余条目指向快照的簇，与快照共享；依次沿用同名条目、同名删除标记或新槽位
+    for (uint16_t j = 0; j < count; j++) {
+        const acfs_data_entry_t* snap = &acfs->snapshot[j];
+        int slot = -1;
+        for (uint16_t i = 0; i < n && slot < 0; i++) {
+            if (staged[i].is_valid && strcmp(staged[i].data_id, snap->data_id) == 0) {
+                slot = i;
+            }
+        }
+        for (uint16_t i = 0; i < n && slot < 0; i++) {
+            if (!staged[i].is_valid && strcmp(staged[i].data_id, snap->data_id) == 0) {
+                slot = i;
+            }
+        }
+        
+        if (slot < 0) {
+            if (n >= max_entries) {
+                // 清除最旧的删除标记
+                int oldest = -1;
+                for (uint16_t i = 0; i < n; i++) {
+                    if (!staged[i].is_valid && (oldest < 0 || staged[i].mod_seq < staged[oldest].mod_seq)) {
+                        oldest = i;
+                    }
+                }
+                if (oldest < 0) {
+                    ret = ACFS_ERROR_CLUSTER_FULL;
+                    goto rollback;
+                }
+                if (staged[oldest].mod_seq > acfs->header.tombstone_floor) {
+                    acfs->header.tombstone_floor = staged[oldest].mod_seq;
+                }
+                n--;
+                memmove(&staged[oldest], &staged[oldest + 1], (n - oldest) * sizeof(acfs_data_entry_t));
+                memmove(&from[oldest], &from[oldest + 1], (n - oldest) * sizeof(uint16_t));
+            }
+            slot = n++;
+            from[slot] = ACFS_OWNER_NONE;
+        }
+        
+        staged[slot] = *snap;
+        staged[slot].cluster_list = lists[j];
+        staged[slot].mod_seq = acfs->header.sequence;
+    }
+    
+    acfs->entries = staged;
+    acfs->header.data_entries = n;
+    acfs->header.free_clusters = old_free + freed;
+    acfs->name_index_dirty = true;
+    ret = acfs_commit_metadata(acfs);
+    if (ret != ACFS_OK) {
+        acfs->entries = old_entries;
+        acfs->header.data_entries = old_count;
+        goto rollback;
+    }
+    acfs->header.free_clusters = old_free;
+    
+    // 提交成功后才作废被移除条目的末簇尾部，再释放旧条目的簇；簇尾部写入失败不影响已提交的回滚
+    acfs_error_t stamp_ret = ACFS_OK;
+    for (uint16_t i = 0; i < old_count; i++) {
+        if (!old_entries[i].is_valid) {
+            continue;
+        }
+        if (!acfs_find_entry(acfs, old_entries[i].data_id)) {
+            acfs_error_t stamp = acfs_mark_deleted(acfs, &old_entries[i]);
+            if (stamp_ret == ACFS_OK) {
+                stamp_ret = stamp;
+            }
+            acfs_value_cache_drop(acfs, i);
+        }
+        acfs_free_clusters(acfs, old_entries[i].cluster_list, old_entries[i].cluster_count);
+        free(old_entries[i].cluster_list);
+    }
+    
+    // 缓存的值随条目移动
+    if (acfs->value_cache) {
+        for (uint16_t i = 0; i < n; i++) {
+            acfs_cached_value_t* cached = NULL;
+            if (from[i] != ACFS_OWNER_NONE) {
+                cached = acfs->value_cache[from[i]];
+                acfs->value_cache[from[i]] = NULL;
+            }
+            acfs->value_cache[i] = cached;
+        }
+    }
+    for (uint16_t i = 0; i < n; i++) {
+        acfs_data_entry_t* entry = &acfs->entries[i];
+        if (!entry->is_valid) {
+            continue;
+        }
+        for (uint16_t k = 0; k < entry->cluster_count; k++) {
+            acfs->cluster_owner[entry->cluster_list[k]].slot = i;
+            acfs->cluster_owner[entry->cluster_list[k]].index = k;
+        }
+        acfs_ref_clusters(acfs, entry->cluster_list, entry->cluster_count);
+    }
+    
+    // 快照之后改动过的条目，其被丢弃的版本的簇尾部序列号更大；重写回滚后各簇的尾部，
+    // 避免元数据重建时把回滚撤销
+    for (uint16_t j = 0; j < count; j++) {
+        const acfs_data_entry_t* snap = &acfs->snapshot[j];
+        bool unchanged = false;
+        for (uint16_t i = 0; i < old_count; i++) {
+            if (old_entries[i].is_valid && strcmp(old_entries[i].data_id, snap->data_id) == 0) {
+                unchanged = (old_entries[i].owner_hash == snap->owner_hash && old_entries[i].mod_seq == snap->mod_seq);
+                break;
+            }
+        }
+        if (!unchanged) {
+            acfs_error_t stamp = acfs_restamp_trailers(acfs, acfs_find_entry(acfs, snap->data_id));
+            if (stamp_ret == ACFS_OK) {
+                stamp_ret = stamp;
+            }
+        }
+        lists[j] = NULL;
+    }
+    staged = old_entries;
+    ret = stamp_ret;
+    
+    acfs->expiry_dirty = true;
+    
+    // 环形记录回到快照时的内容，写入位置需重新扫描
+    memset(acfs->ring_cursor, 0, sizeof(acfs->ring_cursor));
+    
+    // 整卷回滚无法用变更记录描述
+    acfs->change_log_count = 0;
+    acfs->change_log_floor = acfs->header.sequence;
+    goto cleanup;
+    
+rollback:
+    // 内存中的条目表保持不变
+    acfs->header.sequence = old_sequence;
+    acfs->header.tombstone_floor = old_floor;
+    acfs->header.free_clusters = old_free;
+    acfs->name_index_dirty = true;
+    
+cleanup:
+    for (uint16_t i = 0; i < count; i++) {
+        free(lists[i]);
+    }
+    free(lists);
+    free(staged);
+    free(from);
+    return ret;
+}
+
+/**
+ * 删除卷快照
+ */
+acfs_error_t acfs_snapshot_delete(acfs_t* acfs)
+{
+    if (!acfs) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (!(acfs->header.flags & ACFS_FLAG_SNAPSHOT)) {
+        return ACFS_ERROR_DATA_NOT_FOUND;
+    }
+    
+    for (uint16_t i = 0; i < acfs->header.snapshot_entries; i++) {
+        acfs_unref_clusters(acfs, acfs->snapshot[i].cluster_list, acfs->snapshot[i].cluster_count);
+    }
+    acfs_free_snapshot(acfs);
+    
+    return acfs_commit_metadata(acfs);
+}
+
+/**
+ * 流式导出一致性快照
+ */
+acfs_error_t acfs_export(acfs_t* acfs, acfs_stream_write_t write_cb, void* user_data)
+{
+    return acfs_export_entries(acfs, 0, false, write_cb, user_data);
+}
+
+/**
+ * 增量导出
+ */
+acfs_error_t acfs_export_since(acfs_t* acfs, uint32_t since, acfs_stream_write_t write_cb, void* user_data)
+{
+    return acfs_export_entries(acfs, since, true, write_cb, user_data);
+}
+
+/**
+ * 逐簇计算条目前size字节数据的CRC（环形记录、队列和计数器不维护条目CRC）
+ */
+static acfs_error_t acfs_export_data_crc(acfs_t* acfs, const acfs_data_entry_t* entry, uint8_t* buffer,
+                                        uint32_t* crc)
+{
+    uint16_t payload = acfs_cluster_payload(acfs);
+    uint32_t data_crc = acfs_crc32_init();
+    size_t remaining = entry->data_size;
+    for (uint16_t j = 0; j < entry->cluster_count && remaining > 0; j++) {
+        size_t chunk = remaining < payload ? remaining : payload;
+        uint32_t addr = acfs->storage->start_addr + entry->cluster_list[j] * acfs->header.cluster_size;
+        if (acfs->storage->ops.read(addr, buffer, chunk) != 0) {
+            return ACFS_ERROR_IO_ERROR;
+        }
+        data_crc = acfs_crc32_update(data_crc, buffer, chunk);
+        remaining -= chunk;
+    }
+    
+    *crc = acfs_crc32_finalize(data_crc);
+    return ACFS_OK;
+}
+
+/**
+ * 导出修改序列号大于since的条目，增量导出时包含删除标记
+ */
+static acfs_error_t acfs_export_entries(acfs_t* acfs, uint32_t since, bool incremental,
+                                        acfs_stream_write_t write_cb, void* user_data)
+{
+    if (!acfs || !write_cb) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    // 晚于since的删除可能已随删除标记清除而丢失
+    if (incremental && since < acfs->header.tombstone_floor) {
+        return ACFS_ERROR_LOG_TRUNCATED;
+    }
+    
+    uint16_t count = acfs->header.data_entries;
+    acfs_data_entry_t* snapshot = (acfs_data_entry_t*)calloc(count ? count : 1, sizeof(acfs_data_entry_t));
+    uint8_t* buffer = (uint8_t*)malloc(acfs->header.cluster_size);
+    uint16_t taken = 0;
+    bool frozen = false;
+    acfs_error_t ret = ACFS_OK;
+    
+    if (!snapshot || !buffer) {
+        ret = ACFS_ERROR_NO_SPACE;
+        goto cleanup;
+    }
+    
+    // 复制条目元数据作为快照，并持有其全部簇的引用
+    for (uint16_t i = 0; i < count; i++) {
+        const acfs_data_entry_t* entry = &acfs->entries[i];
+        // 已过期的数据在回收时以删除记录导出；
+        // 环形记录、队列和计数器就地更新不改变修改序列号，增量导出时也总是导出
+        bool typed = entry->is_valid && entry->type != ACFS_TYPE_VALUE;
+        if ((!entry->is_valid && !incremental) || (entry->mod_seq <= since && !typed) ||
+            (entry->is_valid && acfs_entry_expired(acfs, entry))) {
+            continue;
+        }
+        
+        snapshot[taken] = *entry;
+        snapshot[taken].cluster_list = (uint16_t*)malloc((entry->cluster_count ? entry->cluster_count : 1) * sizeof(uint16_t));
+        if (!snapshot[taken].cluster_list) {
+            ret = ACFS_ERROR_NO_SPACE;
+            goto cleanup;
+        }
+        if (entry->cluster_count > 0) {
+            memcpy(snapshot[taken].cluster_list, entry->cluster_list, entry->cluster_count * sizeof(uint16_t));
+        }
+        taken++;
+    }
+    
+    for (uint16_t i = 0; i < taken; i++) {
+        acfs_ref_clusters(acfs, snapshot[i].cluster_list, snapshot[i].cluster_count);
+    }
+    acfs->freeze_count++;
+    frozen = true;
+    
+    uint32_t stream_crc = acfs_crc32_init();
+    
+    acfs_archive_header_t archive;
+    archive.magic = ACFS_ARCHIVE_MAGIC;
+    archive.version = ACFS_ARCHIVE_VERSION;
+    archive.entry_count = taken;
+    archive.sequence = acfs->header.sequence;
+    archive.base_sequence = incremental ? since : 0;
+    archive.payload = acfs_cluster_payload(acfs);
+    archive.crc32 = acfs_crc32(&archive, sizeof(acfs_archive_header_t) - sizeof(uint32_t));
+    ret = acfs_stream_put(write_cb, user_data, &archive, sizeof(archive), &stream_crc);
+    if (ret != ACFS_OK) {
+        goto cleanup;
+    }
+    
+    uint16_t payload = acfs_cluster_payload(acfs);
+    for (uint16_t i = 0; i < taken; i++) {
+        const acfs_data_entry_t* entry = &snapshot[i];
+        
+        acfs_archive_record_t record;
+        memset(&record, 0, sizeof(record));
+        strncpy(record.data_id, entry->data_id, ACFS_MAX_DATA_ID_LEN - 1);
+        record.data_size = entry->data_size;
+        record.data_crc = entry->crc32;
+        record.type = entry->type;
+        record.aux = entry->aux;
+        if (entry->is_valid && entry->type != ACFS_TYPE_VALUE) {
+            // 记录头在数据之前输出，先读一遍冻结的簇算出CRC
+            uint32_t typed_crc;
+            ret = acfs_export_data_crc(acfs, entry, buffer, &typed_crc);
+            if (ret != ACFS_OK) {
+                goto cleanup;
+            }
+            record.data_crc = typed_crc;
+        }
+        record.crc32 = acfs_crc32(&record, sizeof(acfs_archive_record_t) - sizeof(uint32_t));
+        ret = acfs_stream_put(write_cb, user_data, &record, sizeof(record), &stream_crc);
+        if (ret != ACFS_OK) {
+            goto cleanup;
+        }
+        
+        // 逐簇读出并校验，不需要整值缓冲区
+        uint32_t data_crc = acfs_crc32_init();
+        size_t remaining = entry->data_size;
+        for (uint16_t j = 0; j < entry->cluster_count && remaining > 0; j++) {
+            size_t chunk = remaining < payload ? remaining : payload;
+            uint32_t addr = acfs->storage->start_addr + entry->cluster_list[j] * acfs->header.cluster_size;
+            if (acfs->storage->ops.read(addr, buffer, chunk) != 0) {
+                ret = ACFS_ERROR_IO_ERROR;
+                goto cleanup;
+            }
+            
+            data_crc = acfs_crc32_update(data_crc, buffer, chunk);
+            ret = acfs_stream_put(write_cb, user_data, buffer, chunk, &stream_crc);
+            if (ret != ACFS_OK) {
+                goto cleanup;
+            }
+            remaining -= chunk;
+        }
+        
+        if (entry->is_valid && acfs_crc32_finalize(data_crc) != record.data_crc) {
+            ret = ACFS_ERROR_CRC_MISMATCH;
+            goto cleanup;
+        }
+    }
+    
+    acfs_archive_footer_t footer;
+    footer.magic = ACFS_ARCHIVE_END_MAGIC;
+    footer.crc32 = acfs_crc32_finalize(stream_crc);
+    ret = acfs_stream_put(write_cb, user_data, &footer, sizeof(footer), NULL);
+    
+cleanup:
+    if (frozen) {
+        // 回收导出期间被覆盖或删除的簇
+        uint16_t freed = 0;
+        for (uint16_t i = 0; i < taken; i++) {
+            freed += acfs_unref_clusters(acfs, snapshot[i].cluster_list, snapshot[i].cluster_count);
+        }
+        acfs->freeze_count--;
+        if (freed > 0) {
+            acfs_save_header(acfs);
+        }
+    }
+    if (snapshot) {
+        for (uint16_t i = 0; i < taken; i++) {
+            free(snapshot[i].cluster_list);
+        }
+        free(snapshot);
+    }
+    free(buffer);
+    return ret;
+}
+
+/**
+ * 从归档批量导入条目
+ */
+acfs_error_t acfs_import(acfs_t* acfs, acfs_stream_read_t read_cb, void* user_data)
+{
+    if (!acfs || !read_cb) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    uint32_t stream_crc = acfs_crc32_init();
+    
+    acfs_archive_header_t archive;
+    acfs_error_t ret = acfs_stream_get(read_cb, user_data, &archive, sizeof(archive), &stream_crc);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    if (archive.magic != ACFS_ARCHIVE_MAGIC || archive.version != ACFS_ARCHIVE_VERSION) {
+        return ACFS_ERROR_DATA_CORRUPTED;
+    }
+    
+    if (archive.crc32 != acfs_crc32(&archive, sizeof(acfs_archive_header_t) - sizeof(uint32_t))) {
+        return ACFS_ERROR_CRC_MISMATCH;
+    }
+    
+    // 独立缓冲区：acfs_write_cluster会使用簇缓冲区
+    uint8_t* buffer = (uint8_t*)malloc(acfs->header.cluster_size);
+    if (!buffer) {
+        return ACFS_ERROR_NO_SPACE;
+    }
+    
+    uint16_t payload = acfs_cluster_payload(acfs);
+    uint16_t imported = 0;
+    
+    for (uint16_t i = 0; i < archive.entry_count; i++) {
+        acfs_archive_record_t record;
+        ret = acfs_stream_get(read_cb, user_data, &record, sizeof(record), &stream_crc);
+        if (ret != ACFS_OK) {
+            break;
+        }
+        
+        if (record.crc32 != acfs_crc32(&record, sizeof(acfs_archive_record_t) - sizeof(uint32_t))) {
+            ret = ACFS_ERROR_CRC_MISMATCH;
+            break;
+        }
+        
+        if (record.data_id[0] == '\0' || record.data_id[ACFS_MAX_DATA_ID_LEN - 1] != '\0' ||
+            record.data_size > (uint32_t)payload * acfs->header.total_clusters || record.type > ACFS_TYPE_COUNTER) {
+            ret = ACFS_ERROR_DATA_CORRUPTED;
+            break;
+        }
+        
+        if (record.data_size == 0) {
+            // 删除记录
+            acfs_data_entry_t* deleted = acfs_find_entry(acfs, record.data_id);
+            if (!deleted) {
+                continue;
+            }
+            acfs->header.sequence++;
+            ret = acfs_remove_entry(acfs, deleted);
+            if (ret != ACFS_OK) {
+                break;
+            }
+            imported++;
+            acfs_log_change(acfs, ACFS_CHANGE_DELETE, deleted->data_id, deleted->type, 0, 0);
+            continue;
+        }
+        
+        // 环形记录、队列和计数器按簇原样写入，簇布局须相同，且就地更新与簇尾部不相容
+        if (record.type != ACFS_TYPE_VALUE &&
+            (archive.payload != payload || (acfs->header.flags & ACFS_FLAG_CLUSTER_TRAILER))) {
+            ret = ACFS_ERROR_INVALID_PARAM;
+            break;
+        }
+        
+        // 同名的环形记录、队列或计数器，或要写入的是这些类型时，先删除旧条目再以新条目写入，
+        // 新的所属标识使旧的写入位置缓存失效
+        acfs_data_entry_t* existing = acfs_find_entry(acfs, record.data_id);
+        if (existing && (existing->type != ACFS_TYPE_VALUE || record.type != ACFS_TYPE_VALUE)) {
+            acfs->header.sequence++;
+            ret = acfs_remove_entry(acfs, existing);
+            if (ret != ACFS_OK) {
+                break;
+            }
+            imported++;
+            acfs_log_change(acfs, ACFS_CHANGE_DELETE, existing->data_id, existing->type, 0, 0);
+        }
+        
+        if (acfs->header.flags & ACFS_FLAG_CACHE) {
+            ret = acfs_cache_make_room(acfs, record.data_id, record.data_size);
+            if (ret != ACFS_OK) {
+                break;
+            }
+        }
+        
+        acfs_data_entry_t* entry;
+        ret = acfs_prepare_entry(acfs, record.data_id, record.data_size, &entry);
+        if (ret != ACFS_OK) {
+            break;
+        }
+        
+        // 末簇尾部使用条目的大小和CRC，须在写入前设置；与普通写入一样清除过期时间
+        entry->data_size = record.data_size;
+        entry->crc32 = record.type == ACFS_TYPE_VALUE ? record.data_crc : 0;
+        entry->type = record.type;
+        entry->aux = record.aux;
+        acfs->header.sequence++;
+        entry->mod_seq = acfs->header.sequence;
+        if (entry->expire_at != 0) {
+            entry->expire_at = 0;
+            acfs->expiry_dirty = true;
+        }
+        entry->referenced = 1;
+        imported++;
+        
+        uint32_t data_crc = acfs_crc32_init();
+        size_t remaining = record.data_size;
+        for (uint16_t j = 0; j < entry->cluster_count; j++) {
+            size_t chunk = remaining < payload ? remaining : payload;
+            ret = acfs_stream_get(read_cb, user_data, buffer, chunk, &stream_crc);
+            if (ret != ACFS_OK) {
+                break;
+            }
+            
+            data_crc = acfs_crc32_update(data_crc, buffer, chunk);
+            if (j == entry->cluster_count - 1 && acfs_crc32_finalize(data_crc) != record.data_crc) {
+                ret = ACFS_ERROR_CRC_MISMATCH;
+                break;
+            }
+            
+            ret = acfs_write_cluster(acfs, entry, j, buffer, chunk);
+            if (ret != ACFS_OK) {
+                break;
+            }
+            remaining -= chunk;
+        }
+        if (ret != ACFS_OK) {
+            break;
+        }
+        
+        acfs_log_change(acfs, ACFS_CHANGE_WRITE, entry->data_id, entry->type, entry->data_size, entry->crc32);
+    }
+    
+    if (ret == ACFS_OK) {
+        uint32_t expected = acfs_crc32_finalize(stream_crc);
+        acfs_archive_footer_t footer;
+        ret = acfs_stream_get(read_cb, user_data, &footer, sizeof(footer), NULL);
+        if (ret == ACFS_OK && (footer.magic != ACFS_ARCHIVE_END_MAGIC || footer.crc32 != expected)) {
+            ret = ACFS_ERROR_CRC_MISMATCH;
+        }
+    }
+    
+    // 全部条目只提交一次元数据
+    if (imported > 0) {
+        acfs_error_t commit_ret = acfs_commit_metadata(acfs);
+        if (ret == ACFS_OK) {
+            ret = commit_ret;
+        }
+    }
+    
+    free(buffer);
+    return ret;
+}
+
+/* 内部函数实现 */
+
+static acfs_error_t acfs_load_header(acfs_t* acfs)
+{
+    uint32_t addr = acfs->storage->start_addr;
+    if (acfs->storage->ops.read(addr, &acfs->header, sizeof(acfs_header_t)) != 0) {
+        return ACFS_ERROR_IO_ERROR;
+    }
+    
+    // 验证魔数
+    if (acfs->header.magic != ACFS_MAGIC_NUMBER) {
+        return ACFS_ERROR_INVALID_FILESYSTEM;
+    }
+    
+    // 主版本号不同的卷头部、条目表和簇布局都不兼容，在校验CRC之前拒绝
+    // （版本号在各版本头部中的偏移相同）
+    if ((acfs->header.version >> 8) != ACFS_VERSION_MAJOR) {
+        return ACFS_ERROR_INVALID_FILESYSTEM;
+    }
+    
+    // 验证CRC
+    uint32_t crc = acfs_crc32(&acfs->header, sizeof(acfs_header_t) - sizeof(uint32_t));
+    if (crc != acfs->header.crc32) {
+        return ACFS_ERROR_DATA_CORRUPTED;
+    }
+    
+    return ACFS_OK;
+}
+
+static acfs_error_t acfs_save_header(acfs_t* acfs)
+{
+    acfs->header.crc32 = acfs_crc32(&acfs->header, sizeof(acfs_header_t) - sizeof(uint32_t));
+    
+    uint32_t addr = acfs->storage->start_addr;
+    if (acfs->storage->ops.write(addr, &acfs->header, sizeof(acfs_header_t)) != 0) {
+        return ACFS_ERROR_IO_ERROR;
+    }
+    
+    return ACFS_OK;
+}
+
+/**
+ * 读取一张条目表及其簇列表（紧接条目表依次存放），addr前进到读取内容之后
+ */
+static acfs_error_t acfs_load_table(acfs_t* acfs, acfs_data_entry_t* entries, uint16_t count,
+                                    uint32_t* addr, uint32_t* crc)
+{
+    uint32_t table_size = count * sizeof(acfs_data_entry_t);
+    if (table_size == 0) {
+        return ACFS_OK;
+    }
+    
+    // 读取条目数据（不包括簇列表）
+    if (acfs->storage->ops.read(*addr, entries, table_size) != 0) {
+        memset(entries, 0, table_size);
+        return ACFS_ERROR_IO_ERROR;
+    }
+    *crc = acfs_crc32_update(*crc, entries, table_size);
+    *addr += table_size;
+    
+    // 存储中的指针无意义，先全部清空
+    for (uint16_t i = 0; i < count; i++) {
+        entries[i].cluster_list = NULL;
+    }
+    
+    // 为每个条目分配和读取簇列表
+    for (uint16_t i = 0; i < count; i++) {
+        acfs_data_entry_t* entry = &entries[i];
+        
+        if (entry->cluster_count > 0) {
+            uint32_t list_size = entry->cluster_count * sizeof(uint16_t);
+            entry->cluster_list = (uint16_t*)malloc(list_size);
+            if (!entry->cluster_list) {
+                return ACFS_ERROR_NO_SPACE;
+            }
+            
+            if (acfs->storage->ops.read(*addr, entry->cluster_list, list_size) != 0) {
+                return ACFS_ERROR_IO_ERROR;
+            }
+            *crc = acfs_crc32_update(*crc, entry->cluster_list, list_size);
+            *addr += list_size;
+        }
+    }
+    
+    return ACFS_OK;
+}
+
+static acfs_error_t acfs_load_entries(acfs_t* acfs)
+{
+    uint32_t addr = acfs->storage->start_addr + sizeof(acfs_header_t);
+    uint32_t crc = acfs_crc32_init();
+    
+    acfs_error_t ret = acfs_load_table(acfs, acfs->entries, acfs->header.data_entries, &addr, &crc);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    // 快照条目表紧接在数据条目的簇列表之后
+    if (acfs->header.flags & ACFS_FLAG_SNAPSHOT) {
+        uint16_t max_entries = (acfs->header.sys_clusters * acfs->header.cluster_size - sizeof(acfs_header_t)) / sizeof(acfs_data_entry_t);
+        if (acfs->header.snapshot_entries > max_entries) {
+            return ACFS_ERROR_DATA_CORRUPTED;
+        }
+        
+        acfs->snapshot = (acfs_data_entry_t*)calloc(acfs->header.snapshot_entries ? acfs->header.snapshot_entries : 1,
+                                                    sizeof(acfs_data_entry_t));
+        if (!acfs->snapshot) {
+            return ACFS_ERROR_NO_SPACE;
+        }
+        
+        ret = acfs_load_table(acfs, acfs->snapshot, acfs->header.snapshot_entries, &addr, &crc);
+        if (ret != ACFS_OK) {
+            return ret;
+        }
+    }
+    
+    // 条目表损坏时不自动格式化，交由acfs_fsck重建
+    if (acfs_crc32_finalize(crc) != acfs->header.entries_crc) {
+        return ACFS_ERROR_DATA_CORRUPTED;
+    }
+    
+    return ACFS_OK;
+}
+
+/**
+ * 一张条目表及其簇列表占用的字节数
+ */
+static uint32_t acfs_table_size(const acfs_data_entry_t* entries, uint16_t count)
+{
+    uint32_t size = count * sizeof(acfs_data_entry_t);
+    for (uint16_t i = 0; i < count; i++) {
+        if (entries[i].cluster_list) {
+            size += entries[i].cluster_count * sizeof(uint16_t);
+        }
+    }
+    return size;
+}
+
+/**
+ * 写入一张条目表及其簇列表，addr前进到写入内容之后
+ */
+static acfs_error_t acfs_save_table(acfs_t* acfs, const acfs_data_entry_t* entries, uint16_t count,
+                                    uint32_t* addr, uint32_t* crc)
+{
+    uint32_t table_size = count * sizeof(acfs_data_entry_t);
+    
+    // 写入条目数据（不包括簇列表）
+    if (acfs->storage->ops.write(*addr, entries, table_size) != 0) {
+        return ACFS_ERROR_IO_ERROR;
+    }
+    *crc = acfs_crc32_update(*crc, entries, table_size);
+    *addr += table_size;
+    
+    // 写入每个条目的簇列表
+    for (uint16_t i = 0; i < count; i++) {
+        const acfs_data_entry_t* entry = &entries[i];
+        
+        if (entry->cluster_count > 0 && entry->cluster_list) {
+            uint32_t list_size = entry->cluster_count * sizeof(uint16_t);
+            if (acfs->storage->ops.write(*addr, entry->cluster_list, list_size) != 0) {
+                return ACFS_ERROR_IO_ERROR;
+            }
+            *crc = acfs_crc32_update(*crc, entry->cluster_list, list_size);
+            *addr += list_size;
+        }
+    }
+    
+    return ACFS_OK;
+}
+
+static acfs_error_t acfs_save_entries(acfs_t* acfs)
+{
+    bool has_snapshot = (acfs->header.flags & ACFS_FLAG_SNAPSHOT) != 0;
+    
+    // 写入前检查，避免超出系统区时留下写了一半的条目表
+    uint32_t total_size = acfs_table_size(acfs->entries, acfs->header.data_entries);
+    if (has_snapshot) {
+        total_size += acfs_table_size(acfs->snapshot, acfs->header.snapshot_entries);
+    }
+    if (sizeof(acfs_header_t) + total_size > (uint32_t)acfs->header.sys_clusters * acfs->header.cluster_size) {
+        return ACFS_ERROR_NO_SPACE;
+    }
+    
+    uint32_t addr = acfs->storage->start_addr + sizeof(acfs_header_t);
+    uint32_t crc = acfs_crc32_init();
+    
+    acfs_error_t ret = acfs_save_table(acfs, acfs->entries, acfs->header.data_entries, &addr, &crc);
+    if (ret == ACFS_OK && has_snapshot) {
+        ret = acfs_save_table(acfs, acfs->snapshot, acfs->header.snapshot_entries, &addr, &crc);
+    }
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    acfs->header.entries_crc = acfs_crc32_finalize(crc);
+    return ACFS_OK;
+}
+
+static acfs_error_t acfs_commit_metadata(acfs_t* acfs)
+{
+    acfs_error_t ret = acfs_save_entries(acfs);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    return acfs_save_header(acfs);
+}
+
+static acfs_error_t acfs_init_bitmap(acfs_t* acfs)
+{
+    size_t bitmap_size = (acfs->header.total_clusters + 7) / 8;
+    memset(acfs->cluster_bitmap, 0, bitmap_size);
+    
+    // 反向映射全部置为无所属（0xFF填充即ACFS_OWNER_NONE）
+    memset(acfs->cluster_owner, 0xFF, acfs->header.total_clusters * sizeof(acfs_cluster_owner_t));
+    memset(acfs->cluster_refs, 0, acfs->header.total_clusters);
+    
+    // 标记系统簇为已使用
+    for (uint16_t i = 0; i < acfs->header.sys_clusters; i++) {
+        uint16_t byte_idx = i / 8;
+        uint8_t bit_idx = i % 8;
+        acfs->cluster_bitmap[byte_idx] |= (1 << bit_idx);
+    }
+    
+    // 标记数据簇为已使用
+    for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
+        acfs_data_entry_t* entry = &acfs->entries[i];
+        if (entry->is_valid && entry->cluster_list) {
+            for (uint16_t j = 0; j < entry->cluster_count; j++) {
+                uint16_t cluster = entry->cluster_list[j];
+                uint16_t byte_idx = cluster / 8;
+                uint8_t bit_idx = cluster % 8;
+                acfs->cluster_bitmap[byte_idx] |= (1 << bit_idx);
+                acfs->cluster_owner[cluster].slot = i;
+                acfs->cluster_owner[cluster].index = j;
+                acfs->cluster_refs[cluster]++;
+            }
+        }
+    }
+    
+    // 快照引用的簇同样占用
+    if (acfs->snapshot) {
+        for (uint16_t i = 0; i < acfs->header.snapshot_entries; i++) {
+            const acfs_data_entry_t* entry = &acfs->snapshot[i];
+            for (uint16_t j = 0; j < entry->cluster_count; j++) {
+                uint16_t cluster = entry->cluster_list[j];
+                acfs->cluster_bitmap[cluster / 8] |= (1 << (cluster % 8));
+                acfs->cluster_refs[cluster]++;
+            }
+        }
+    }
+    
+    // 空闲簇数以位图为准（导出期间掉电时头部记录的值偏小）
+    uint16_t free_clusters = 0;
+    for (uint16_t i = acfs->header.sys_clusters; i < acfs->header.total_clusters; i++) {
+        if (!(acfs->cluster_bitmap[i / 8] & (1 << (i % 8)))) {
+            free_clusters++;
+        }
+    }
+    acfs->header.free_clusters = free_clusters;
+    
+    return acfs_allocator(acfs)->mount(acfs);
+}
+
+static acfs_error_t acfs_allocate_clusters(acfs_t* acfs, uint16_t count, uint16_t* cluster_list, uint16_t owner_slot)
+{
+    // 优先按顺序使用为该数据预留的簇，它们已计入已用
+    acfs_reservation_t* reservation = acfs_find_reservation(acfs, acfs->entries[owner_slot].data_id);
+    uint16_t reserved = 0;
+    if (reservation) {
+        reserved = reservation->remaining < count ? reservation->remaining : count;
+    }
+    
+    if (acfs->header.free_clusters < count - reserved) {
+        return ACFS_ERROR_NO_SPACE;
+    }
+    
+    uint16_t allocated = 0;
+    while (allocated < reserved) {
+        cluster_list[allocated] = reservation->next + allocated;
+        allocated++;
+    }
+    
+    // 由分配策略逐段选择空闲簇，同一分组的数据从分组区域开始依次存放
+    const acfs_allocator_t* allocator = acfs_allocator(acfs);
+    uint16_t hint = acfs_group_hint(acfs, acfs->entries[owner_slot].data_id);
+    if (hint == ACFS_HINT_NONE && allocated < count) {
+        allocated += acfs_magazine_take(acfs, count - allocated, cluster_list + allocated);
+    }
+    while (allocated < count) {
+        uint16_t start = 0;
+        uint16_t length = allocator->allocate(acfs, count - allocated, false, hint, &start);
+        if (length == 0) {
+            // 剩余的空闲簇可能都在单簇分配缓存中
+            if (acfs_magazine_flush(acfs) > 0) {
+                continue;
+            }
+            break;
+        }
+        
+        for (uint16_t i = start; i < start + length; i++) {
+            // 标记为已使用
+            acfs->cluster_bitmap[i / 8] |= (1 << (i % 8));
+            cluster_list[allocated++] = i;
+        }
+        if (hint != ACFS_HINT_NONE) {
+            hint = start + length;
+        }
+    }
+    
+    if (allocated < count) {
+        // 回滚已分配的簇，预留的簇保持预留
+        for (uint16_t i = reserved; i < allocated; i++) {
+            uint16_t cluster = cluster_list[i];
+            uint16_t byte_idx = cluster / 8;
+            uint8_t bit_idx = cluster % 8;
+            acfs->cluster_bitmap[byte_idx] &= ~(1 << bit_idx);
+            allocator->release(acfs, cluster, 1);
+        }
+        return ACFS_ERROR_NO_SPACE;
+    }
+    
+    // 记录反向映射
+    for (uint16_t i = 0; i < count; i++) {
+        acfs->cluster_owner[cluster_list[i]].slot = owner_slot;
+        acfs->cluster_owner[cluster_list[i]].index = i;
+        acfs->cluster_refs[cluster_list[i]] = 1;
+    }
+    
+    if (reserved > 0) {
+        reservation->next += reserved;
+        reservation->remaining -= reserved;
+        if (reservation->remaining == 0) {
+            reservation->data_id[0] = '\0';
+        }
+    }
+    
+    acfs->header.free_clusters -= count - reserved;
+    return ACFS_OK;
+}
+
+/**
+ * 实例使用的分配策略；未挂载的临时实例（如元数据重建期间）按位图取首个空闲簇
+ */
+static const acfs_allocator_t* acfs_allocator(const acfs_t* acfs)
+{
+    return acfs->allocator ? acfs->allocator : &acfs_allocator_first_fit;
+}
+
+/**
+ * 从单簇分配缓存取簇：缓存足够时直接交出，单簇分配遇到缓存为空时先由分配策略补充一段；
+ * 多簇分配在缓存不足时返回0，交给分配策略以保持连续
+ */
+static uint16_t acfs_magazine_take(acfs_t* acfs, uint16_t count, uint16_t* cluster_list)
+{
+    acfs_magazine_t* magazine = &acfs->magazine;
+    if (acfs->magazine_size == 0) {
+        return 0;
+    }
+    
+    if (count > magazine->remaining) {
+        if (count > 1) {
+            return 0;
+        }
+        
+        uint16_t start = 0;
+        uint16_t length = acfs_allocator(acfs)->allocate(acfs, acfs->magazine_size, false, ACFS_HINT_NONE, &start);
+        if (length == 0) {
+            return 0;
+        }
+        for (uint16_t i = start; i < start + length; i++) {
+            acfs->cluster_bitmap[i / 8] |= (1 << (i % 8));
+        }
+        magazine->next = start;
+        magazine->remaining = length;
+    }
+    
+    for (uint16_t i = 0; i < count; i++) {
+        cluster_list[i] = magazine->next++;
+    }
+    magazine->remaining -= count;
+    return count;
+}
+
+/**
+ * 把单簇分配缓存中的簇归还分配策略，返回归还的簇数
+ */
+static uint16_t acfs_magazine_flush(acfs_t* acfs)
+{
+    acfs_magazine_t* magazine = &acfs->magazine;
+    uint16_t count = magazine->remaining;
+    if (count == 0) {
+        return 0;
+    }
+    
+    for (uint16_t i = magazine->next; i < magazine->next + count; i++) {
+        acfs->cluster_bitmap[i / 8] &= ~(1 << (i % 8));
+    }
+    acfs_allocator(acfs)->release(acfs, magazine->next, count);
+    magazine->remaining = 0;
+    return count;
+}
+
+/**
+ * 分组区域的起始簇：显式分组优先，否则取数据标识最后一个分隔符之前的前缀；不属于任何分组时返回ACFS_HINT_NONE
+ */
+static uint16_t acfs_group_hint(const acfs_t* acfs, const char* data_id)
+{
+    uint32_t hash;
+    if (acfs->placement_group) {
+        hash = acfs_crc32(acfs->placement_group, strlen(acfs->placement_group));
+    } else if (acfs->group_separator != '\0') {
+        const char* end = strrchr(data_id, acfs->group_separator);
+        if (!end || end == data_id) {
+            return ACFS_HINT_NONE;
+        }
+        hash = acfs_crc32(data_id, end - data_id);
+    } else {
+        return ACFS_HINT_NONE;
+    }
+    
+    uint16_t data_clusters = acfs->header.total_clusters - acfs->header.sys_clusters;
+    uint16_t regions = acfs->group_regions < data_clusters ? acfs->group_regions : data_clusters;
+    if (regions == 0) {
+        return ACFS_HINT_NONE;
+    }
+    
+    return acfs->header.sys_clusters + (hash % regions) * (data_clusters / regions);
+}
+
+static acfs_reservation_t* acfs_find_reservation(acfs_t* acfs, const char* data_id)
+{
+    for (uint16_t i = 0; i < ACFS_RESERVATIONS; i++) {
+        if (acfs->reservations[i].data_id[0] != '\0' && strcmp(acfs->reservations[i].data_id, data_id) == 0) {
+            return &acfs->reservations[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * 把条目的簇数调整为count：保留共同前缀，只释放或追加尾部的簇
+ */
+static acfs_error_t acfs_resize_clusters(acfs_t* acfs, acfs_data_entry_t* entry, uint16_t count)
+{
+    uint16_t old_count = entry->cluster_count;
+    if (count < old_count) {
+        acfs_free_clusters(acfs, entry->cluster_list + count, old_count - count);
+        entry->cluster_count = count;
+        // 缩小失败时沿用原来的内存块
+        uint16_t* list = (uint16_t*)realloc(entry->cluster_list, count * sizeof(uint16_t));
+        if (list) {
+            entry->cluster_list = list;
+        }
+        return ACFS_OK;
+    }
+    
+    if (count == old_count) {
+        return ACFS_OK;
+    }
+    
+    uint16_t* list = (uint16_t*)realloc(entry->cluster_list, count * sizeof(uint16_t));
+    if (!list) {
+        return ACFS_ERROR_NO_SPACE;
+    }
+    entry->cluster_list = list;
+    
+    acfs_error_t ret = acfs_allocate_clusters(acfs, count - old_count, list + old_count,
+                                              (uint16_t)(entry - acfs->entries));
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    for (uint16_t i = old_count; i < count; i++) {
+        acfs->cluster_owner[list[i]].index = i;
+    }
+    entry->cluster_count = count;
+    return ACFS_OK;
+}
+
+static void acfs_free_clusters(acfs_t* acfs, uint16_t* cluster_list, uint16_t count)
+{
+    // 条目放弃这些簇；仍被快照或导出引用的簇保持占用
+    for (uint16_t i = 0; i < count; i++) {
+        acfs->cluster_owner[cluster_list[i]].slot = ACFS_OWNER_NONE;
+        acfs->cluster_owner[cluster_list[i]].index = ACFS_OWNER_NONE;
+    }
+    
+    acfs_unref_clusters(acfs, cluster_list, count);
+}
+
+static void acfs_ref_clusters(acfs_t* acfs, const uint16_t* cluster_list, uint16_t count)
+{
+    for (uint16_t i = 0; i < count; i++) {
+        acfs->cluster_refs[cluster_list[i]]++;
+    }
+}
+
+/**
+ * 减少簇引用，引用归零的簇回收，返回回收的簇数
+ */
+static uint16_t acfs_unref_clusters(acfs_t* acfs, const uint16_t* cluster_list, uint16_t count)
+{
+    uint16_t freed = 0;
+    
+    for (uint16_t i = 0; i < count; i++) {
+        uint16_t cluster = cluster_list[i];
+        if (--acfs->cluster_refs[cluster] > 0) {
+            continue;
+        }
+        
+        uint16_t byte_idx = cluster / 8;
+        uint8_t bit_idx = cluster % 8;
+        acfs->cluster_bitmap[byte_idx] &= ~(1 << bit_idx);
+        acfs_allocator(acfs)->release(acfs, cluster, 1);
+        freed++;
+    }
+    
+    acfs->header.free_clusters += freed;
+    return freed;
+}
+
+/**
+ * 条目是否有簇被快照或导出共享（共享簇不得原地覆盖）
+ */
+static bool acfs_entry_shared(const acfs_t* acfs, const acfs_data_entry_t* entry)
+{
+    for (uint16_t i = 0; i < entry->cluster_count; i++) {
+        if (acfs->cluster_refs[entry->cluster_list[i]] > 1) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * 释放快照条目表（不处理簇引用）
+ */
+static void acfs_free_snapshot(acfs_t* acfs)
+{
+    if (acfs->snapshot) {
+        for (uint16_t i = 0; i < acfs->header.snapshot_entries; i++) {
+            free(acfs->snapshot[i].cluster_list);
+        }
+        free(acfs->snapshot);
+        acfs->snapshot = NULL;
+    }
+    
+    acfs->header.snapshot_entries = 0;
+    acfs->header.flags &= ~ACFS_FLAG_SNAPSHOT;
+}
+
+/**
+ * 查找或创建条目，并为其准备足够容纳size字节的簇
+ */
+static acfs_error_t acfs_prepare_entry(acfs_t* acfs, const char* data_id, size_t size, acfs_data_entry_t** out)
+{
+    uint16_t clusters_needed = acfs_calculate_clusters_needed(acfs_cluster_payload(acfs), size);
+    
+    // 查找现有条目
+    acfs_data_entry_t* entry = acfs_find_entry(acfs, data_id);
+    
+    if (entry) {
+        // 更新现有数据；与快照或导出共享的簇不得原地覆盖
+        if (acfs_entry_shared(acfs, entry)) {
+            // 重新分配簇，分配成功后才释放旧簇，失败时条目保持原值
+            uint16_t* cluster_list = (uint16_t*)malloc(clusters_needed * sizeof(uint16_t));
+            if (!cluster_list) {
+                return ACFS_ERROR_NO_SPACE;
+            }
+            
+            acfs_error_t ret = acfs_allocate_clusters(acfs, clusters_needed, cluster_list,
+                                                      (uint16_t)(entry - acfs->entries));
+            if (ret != ACFS_OK) {
+                free(cluster_list);
+                return ret;
+            }
+            
+            acfs_free_clusters(acfs, entry->cluster_list, entry->cluster_count);
+            free(entry->cluster_list);
+            entry->cluster_list = cluster_list;
+            entry->cluster_count = clusters_needed;
+        } else if (entry->cluster_count != clusters_needed) {
+            // 保留共同前缀的簇，只释放或追加尾部
+            acfs_error_t ret = acfs_resize_clusters(acfs, entry, clusters_needed);
+            if (ret != ACFS_OK) {
+                return ret;
+            }
+        }
+    } else {
+        // 创建新条目，优先复用同名删除标记的槽位
+        entry = acfs_find_tombstone(acfs, data_id);
+        bool new_slot = (entry == NULL);
+        if (new_slot) {
+            if (acfs->header.data_entries >= (acfs->header.sys_clusters * acfs->header.cluster_size - sizeof(acfs_header_t)) / sizeof(acfs_data_entry_t)) {
+                // 条目表已满时清除最旧的删除标记
+                acfs_error_t ret = acfs_purge_tombstone(acfs);
+                if (ret != ACFS_OK) {
+                    return ret;
+                }
+            }
+            
+            entry = &acfs->entries[acfs->header.data_entries];
+            strncpy(entry->data_id, data_id, ACFS_MAX_DATA_ID_LEN - 1);
+            entry->data_id[ACFS_MAX_DATA_ID_LEN - 1] = '\0';
+        }
+        // 所属标识在条目生命周期内不变，混入序列号以区分同名的先后条目
+        entry->owner_hash = acfs_crc32(data_id, strlen(data_id)) ^ acfs->header.sequence;
+        
+        entry->cluster_list = (uint16_t*)malloc(clusters_needed * sizeof(uint16_t));
+        if (!entry->cluster_list) {
+            return ACFS_ERROR_NO_SPACE;
+        }
+        
+        acfs_error_t ret = acfs_allocate_clusters(acfs, clusters_needed, entry->cluster_list,
+                                                  (uint16_t)(entry - acfs->entries));
+        if (ret != ACFS_OK) {
+            free(entry->cluster_list);
+            entry->cluster_list = NULL;
+            return ret;
+        }
+        
+        entry->cluster_count = clusters_needed;
+        entry->is_valid = true;
+        if (new_slot) {
+            acfs->header.data_entries++;
+        }
+        acfs->name_index_dirty = true;
+    }
+    
+    entry->type = ACFS_TYPE_VALUE;
+    entry->aux = 0;
+    *out = entry;
+    return ACFS_OK;
+}
+
+/**
+ * 把条目转为删除标记：作废簇尾部并释放簇，保留槽位、名称和修改序列号供增量导出
+ */
+static acfs_error_t acfs_remove_entry(acfs_t* acfs, acfs_data_entry_t* entry)
+{
+    // 作废簇尾部，避免元数据重建时复活已删除的数据
+    acfs_error_t ret = acfs_mark_deleted(acfs, entry);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    acfs_free_clusters(acfs, entry->cluster_list, entry->cluster_count);
+    free(entry->cluster_list);
+    entry->cluster_list = NULL;
+    entry->cluster_count = 0;
+    entry->data_size = 0;
+    entry->crc32 = 0;
+    entry->mod_seq = acfs->header.sequence;
+    entry->expire_at = 0;
+    entry->referenced = 0;
+    entry->is_valid = false;
+    acfs_value_cache_drop(acfs, (uint16_t)(entry - acfs->entries));
+    acfs->name_index_dirty = true;
+    return ACFS_OK;
+}
+
+static acfs_data_entry_t* acfs_find_tombstone(acfs_t* acfs, const char* data_id)
+{
+    for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
+        if (!acfs->entries[i].is_valid && 
+            strcmp(acfs->entries[i].data_id, data_id) == 0) {
+            return &acfs->entries[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * 清除修改序列号最小的删除标记，腾出一个槽位
+ */
+static acfs_error_t acfs_purge_tombstone(acfs_t* acfs)
+{
+    int oldest = -1;
+    for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
+        if (!acfs->entries[i].is_valid &&
+            (oldest < 0 || acfs->entries[i].mod_seq < acfs->entries[oldest].mod_seq)) {
+            oldest = i;
+        }
+    }
+    
+    if (oldest < 0) {
+        return ACFS_ERROR_CLUSTER_FULL;
+    }
+    
+    // 早于此序列号的增量导出不再能得到完整的删除记录
+    if (acfs->entries[oldest].mod_seq > acfs->header.tombstone_floor) {
+        acfs->header.tombstone_floor = acfs->entries[oldest].mod_seq;
+    }
+    
+    // 移动其他条目，缓存的值随之移动
+    for (int i = oldest; i < acfs->header.data_entries - 1; i++) {
+        acfs->entries[i] = acfs->entries[i + 1];
+        acfs_set_owner_slot(acfs, (uint16_t)i);
+        if (acfs->value_cache) {
+            acfs->value_cache[i] = acfs->value_cache[i + 1];
+        }
+    }
+    
+    acfs->header.data_entries--;
+    memset(&acfs->entries[acfs->header.data_entries], 0, sizeof(acfs_data_entry_t));
+    if (acfs->value_cache) {
+        acfs->value_cache[acfs->header.data_entries] = NULL;
+    }
+    acfs->expiry_dirty = true;
+    acfs->name_index_dirty = true;
+    return ACFS_OK;
+}
+
+static bool acfs_entry_expired(const acfs_t* acfs, const acfs_data_entry_t* entry)
+{
+    return entry->expire_at != 0 && acfs->get_time && acfs->get_time() >= entry->expire_at;
+}
+
+/**
+ * 把过期时间加入过期索引；索引未建立或已满时留待重建
+ */
+static void acfs_expiry_push(acfs_t* acfs, uint32_t expire_at, uint16_t slot)
+{
+    if (acfs->expiry_dirty || acfs->expiry_count >= acfs->expiry_capacity) {
+        acfs->expiry_dirty = true;
+        return;
+    }
+    
+    uint16_t i = acfs->expiry_count++;
+    while (i > 0) {
+        uint16_t parent = (i - 1) / 2;
+        if (acfs->expiry_heap[parent].expire_at <= expire_at) {
+            break;
+        }
+        acfs->expiry_heap[i] = acfs->expiry_heap[parent];
+        i = parent;
+    }
+    acfs->expiry_heap[i].expire_at = expire_at;
+    acfs->expiry_heap[i].slot = slot;
+}
+
+/**
+ * 从条目表重建过期索引
+ */
+static acfs_error_t acfs_expiry_rebuild(acfs_t* acfs)
+{
+    if (!acfs->expiry_heap) {
+        uint16_t max_entries = (acfs->header.sys_clusters * acfs->header.cluster_size - sizeof(acfs_header_t)) / sizeof(acfs_data_entry_t);
+        acfs->expiry_heap = (acfs_expiry_t*)malloc(max_entries * sizeof(acfs_expiry_t));
+        if (!acfs->expiry_heap) {
+            return ACFS_ERROR_NO_SPACE;
+        }
+        acfs->expiry_capacity = max_entries;
+    }
+    
+    acfs->expiry_count = 0;
+    acfs->expiry_dirty = false;
+    for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
+        if (acfs->entries[i].is_valid && acfs->entries[i].expire_at != 0) {
+            acfs_expiry_push(acfs, acfs->entries[i].expire_at, i);
+        }
+    }
+    
+    return ACFS_OK;
+}
+
+/**
+ * 为槽位分配值缓存项（替换已有的项），容量不足时换出未固定的项
+ * 返回的项由调用者填入数据和版本；失败返回NULL，已固定的旧项保留并标记为过期
+ */
+static acfs_cached_value_t* acfs_value_cache_alloc(acfs_t* acfs, uint16_t slot, uint32_t size, bool pinned)
+{
+    if (!acfs->value_cache) {
+        uint16_t max_entries = (acfs->header.sys_clusters * acfs->header.cluster_size - sizeof(acfs_header_t)) / sizeof(acfs_data_entry_t);
+        acfs->value_cache = (acfs_cached_value_t**)calloc(max_entries, sizeof(acfs_cached_value_t*));
+        if (!acfs->value_cache) {
+            return NULL;
+        }
+    }
+    
+    // 已固定的旧项在新项分配成功后才释放，失败时仍保持固定，下次读取重新填入
+    acfs_cached_value_t* old = acfs->value_cache[slot];
+    if (old && !old->pinned) {
+        acfs_value_cache_drop(acfs, slot);
+        old = NULL;
+    }
+    uint32_t reuse = old ? old->size : 0;
+    if (size > acfs->value_cache_size) {
+        if (old) {
+            old->mod_seq = 0;
+        }
+        return NULL;
+    }
+    
+    // 轮转换出未固定的项
+    uint32_t steps = 0;
+    while (acfs->value_cache_used - reuse + size > acfs->value_cache_size && steps < acfs->header.data_entries) {
+        if (acfs->value_cache_hand >= acfs->header.data_entries) {
+            acfs->value_cache_hand = 0;
+        }
+        acfs_cached_value_t* victim = acfs->value_cache[acfs->value_cache_hand];
+        if (victim && !victim->pinned) {
+            acfs_value_cache_drop(acfs, acfs->value_cache_hand);
+        }
+        acfs->value_cache_hand++;
+        steps++;
+    }
+    
+    acfs_cached_value_t* cached = NULL;
+    if (acfs->value_cache_used - reuse + size <= acfs->value_cache_size) {
+        cached = (acfs_cached_value_t*)malloc(sizeof(acfs_cached_value_t) + size);
+    }
+    if (!cached) {
+        if (old) {
+            old->mod_seq = 0;
+        }
+        return NULL;
+    }
+    
+    acfs_value_cache_drop(acfs, slot);
+    cached->mod_seq = 0;
+    cached->size = size;
+    cached->pinned = pinned;
+    acfs->value_cache[slot] = cached;
+    acfs->value_cache_used += size;
+    return cached;
+}
+
+/**
+ * 释放槽位的值缓存项
+ */
+static void acfs_value_cache_drop(acfs_t* acfs, uint16_t slot)
+{
+    if (!acfs->value_cache || !acfs->value_cache[slot]) {
+        return;
+    }
+    
+    acfs->value_cache_used -= acfs->value_cache[slot]->size;
+    free(acfs->value_cache[slot]);
+    acfs->value_cache[slot] = NULL;
+}
+
+/**
+ * 读取环形记录第index个槽的序号
+ */
+static acfs_error_t acfs_ring_slot_seq(acfs_t* acfs, const acfs_data_entry_t* entry,
+                                       const acfs_ring_cursor_t* ring, uint32_t index, uint64_t* seq)
+{
+    uint32_t slot_size = sizeof(acfs_ring_slot_t) + ring->record_size;
+    uint16_t cluster = entry->cluster_list[1 + index / ring->per_cluster];
+    uint32_t addr = acfs->storage->start_addr + cluster * acfs->header.cluster_size +
+                    (index % ring->per_cluster) * slot_size;
+    
+    acfs_ring_slot_t slot;
+    if (acfs->storage->ops.read(addr, &slot, sizeof(slot)) != 0) {
+        return ACFS_ERROR_IO_ERROR;
+    }
+    
+    *seq = slot.seq;
+    return ACFS_OK;
+}
+
+/**
+ * 取得环形记录的写入位置
+ * 位置缓存未命中时读取首簇，并二分查找序号最大的槽：
+ * 最新一轮写入的槽序号连续递增，其后为上一轮的槽或空槽。
+ */
+static acfs_error_t acfs_ring_open(acfs_t* acfs, const acfs_data_entry_t* entry, acfs_ring_cursor_t** out)
+{
+    for (uint8_t i = 0; i < ACFS_RING_CURSORS; i++) {
+        if (acfs->ring_cursor[i].owner_hash == entry->owner_hash && acfs->ring_cursor[i].next_seq != 0) {
+            *out = &acfs->ring_cursor[i];
+            return ACFS_OK;
+        }
+    }
+    
+    acfs_ring_header_t header;
+    uint32_t addr = acfs->storage->start_addr + entry->cluster_list[0] * acfs->header.cluster_size;
+    if (acfs->storage->ops.read(addr, &header, sizeof(header)) != 0) {
+        return ACFS_ERROR_IO_ERROR;
+    }
+    
+    if (header.magic != ACFS_RING_MAGIC ||
+        header.crc32 != acfs_crc32(&header, sizeof(acfs_ring_header_t) - sizeof(uint32_t))) {
+        return ACFS_ERROR_DATA_CORRUPTED;
+    }
+    
+    acfs_ring_cursor_t ring;
+    ring.owner_hash = entry->owner_hash;
+    ring.record_size = header.record_size;
+    ring.per_cluster = header.per_cluster;
+    ring.capacity = header.capacity;
+    
+    uint64_t first;
+    acfs_error_t ret = acfs_ring_slot_seq(acfs, entry, &ring, 0, &first);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    // 槽0为空说明尚无记录
+    uint64_t last = 0;
+    if (first != 0) {
+        uint32_t lo = 0;
+        uint32_t hi = ring.capacity - 1;
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo + 1) / 2;
+            uint64_t seq;
+            ret = acfs_ring_slot_seq(acfs, entry, &ring, mid, &seq);
+            if (ret != ACFS_OK) {
+                return ret;
+            }
+            if (seq != 0 && seq >= first) {
+                lo = mid;
+            } else {
+                hi = mid - 1;
+            }
+        }
+        ret = acfs_ring_slot_seq(acfs, entry, &ring, lo, &last);
+        if (ret != ACFS_OK) {
+            return ret;
+        }
+    }
+    ring.next_seq = last + 1;
+    
+    acfs_ring_cursor_t* cursor = &acfs->ring_cursor[acfs->ring_cursor_next];
+    acfs->ring_cursor_next = (acfs->ring_cursor_next + 1) % ACFS_RING_CURSORS;
+    *cursor = ring;
+    *out = cursor;
+    return ACFS_OK;
+}
+
+/**
+ * 校验环形记录头和全部已写入的记录
+ */
+static acfs_error_t acfs_ring_check(acfs_t* acfs, const acfs_data_entry_t* entry)
+{
+    acfs_ring_cursor_t* cursor;
+    acfs_error_t ret = acfs_ring_open(acfs, entry, &cursor);
+    if (ret != ACFS_OK) {
+        return ret == ACFS_ERROR_IO_ERROR ? ret : ACFS_ERROR_DATA_CORRUPTED;
+    }
+    
+    uint32_t slot_size = sizeof(acfs_ring_slot_t) + cursor->record_size;
+    for (uint32_t index = 0; index < cursor->capacity; index++) {
+        uint16_t cluster = entry->cluster_list[1 + index / cursor->per_cluster];
+        uint32_t addr = acfs->storage->start_addr + cluster * acfs->header.cluster_size +
+                        (index % cursor->per_cluster) * slot_size;
+        if (acfs->storage->ops.read(addr, acfs->cluster_buffer, slot_size) != 0) {
+            return ACFS_ERROR_IO_ERROR;
+        }
+        
+        const acfs_ring_slot_t* slot = (const acfs_ring_slot_t*)acfs->cluster_buffer;
+        if (slot->seq == 0) {
+            continue;
+        }
+        uint32_t crc = acfs_crc32_update(acfs_crc32_init(), &slot->seq, sizeof(slot->seq));
+        crc = acfs_crc32_update(crc, acfs->cluster_buffer + sizeof(acfs_ring_slot_t), cursor->record_size);
+        if (acfs_crc32_finalize(crc) != slot->crc32) {
+            return ACFS_ERROR_DATA_CORRUPTED;
+        }
+    }
+    
+    return ACFS_OK;
+}
+
+/**
+ * 查找指定类型的条目；modify为true时先解除与快照或导出的簇共享
+ */
+static acfs_error_t acfs_find_typed(acfs_t* acfs, const char* data_id, uint8_t type, bool modify,
+                                    acfs_data_entry_t** out)
+{
+    acfs_data_entry_t* entry = acfs_find_entry(acfs, data_id);
+    if (!entry || acfs_entry_expired(acfs, entry)) {
+        return ACFS_ERROR_DATA_NOT_FOUND;
+    }
+    
+    if (entry->type != type) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    // 与快照或导出共享的簇先复制，之后的就地写入不影响它们
+    if (modify && acfs_entry_shared(acfs, entry)) {
+        acfs_error_t ret = acfs_unshare_entry(acfs, entry);
+        if (ret != ACFS_OK) {
+            return ret;
+        }
+    }
+    
+    // 读写都算作访问，缓存模式下持续使用的条目不被淘汰
+    entry->referenced = 1;
+    *out = entry;
+    return ACFS_OK;
+}
+
+/**
+ * 读取队列头，取两个副本中有效且更新次数较大的一个
+ */
+static acfs_error_t acfs_queue_load(acfs_t* acfs, const acfs_data_entry_t* entry, acfs_queue_header_t* header)
+{
+    uint8_t raw[2 * ACFS_QUEUE_HEADER_SLOT];
+    uint32_t addr = acfs->storage->start_addr + entry->cluster_list[0] * acfs->header.cluster_size;
+    if (acfs->storage->ops.read(addr, raw, sizeof(raw)) != 0) {
+        return ACFS_ERROR_IO_ERROR;
+    }
+    
+    bool found = false;
+    for (int i = 0; i < 2; i++) {
+        acfs_queue_header_t copy;
+        memcpy(&copy, raw + i * ACFS_QUEUE_HEADER_SLOT, sizeof(copy));
+        if (copy.magic != ACFS_QUEUE_MAGIC ||
+            copy.crc32 != acfs_crc32(&copy, sizeof(acfs_queue_header_t) - sizeof(uint32_t))) {
+            continue;
+        }
+        if (!found || copy.seq > header->seq) {
+            *header = copy;
+            found = true;
+        }
+    }
+    
+    return found ? ACFS_OK : ACFS_ERROR_DATA_CORRUPTED;
+}
+
+/**
+ * 写入队列头到较旧的副本位置，写入中断时另一副本仍然有效
+ */
+static acfs_error_t acfs_queue_store(acfs_t* acfs, const acfs_data_entry_t* entry, acfs_queue_header_t* header)
+{
+    header->magic = ACFS_QUEUE_MAGIC;
+    header->seq++;
+    header->crc32 = acfs_crc32(header, sizeof(acfs_queue_header_t) - sizeof(uint32_t));
+    
+    uint32_t addr = acfs->storage->start_addr + entry->cluster_list[0] * acfs->header.cluster_size +
+                    (header->seq % 2) * ACFS_QUEUE_HEADER_SLOT;
+    if (acfs->storage->ops.write(addr, header, sizeof(acfs_queue_header_t)) != 0) {
+        return ACFS_ERROR_IO_ERROR;
+    }
+    
+    return ACFS_OK;
+}
+
+/**
+ * 读出队首消息并前移队首（只修改内存中的队列头）
+ */
+static acfs_error_t acfs_queue_take(acfs_t* acfs, const acfs_data_entry_t* entry, acfs_queue_header_t* header,
+                                    uint8_t* data, uint16_t* size)
+{
+    uint16_t payload = acfs_cluster_payload(acfs);
+    uint32_t cluster = header->head_cluster;
+    uint16_t offset = header->head_offset;
+    acfs_queue_record_t record;
+    uint32_t addr;
+    
+    while (true) {
+        if ((size_t)(payload - offset) < sizeof(acfs_queue_record_t)) {
+            cluster++;
+            offset = 0;
+        }
+        
+        if (cluster < entry->aux || cluster - entry->aux >= (uint32_t)entry->cluster_count - 1) {
+            return ACFS_ERROR_DATA_CORRUPTED;
+        }
+        
+        addr = acfs->storage->start_addr +
+               entry->cluster_list[1 + cluster - entry->aux] * acfs->header.cluster_size + offset;
+        if (acfs->storage->ops.read(addr, &record, sizeof(record)) != 0) {
+            return ACFS_ERROR_IO_ERROR;
+        }
+        
+        if (record.magic != ACFS_QUEUE_SKIP_MAGIC) {
+            break;
+        }
+        cluster++;
+        offset = 0;
+    }
+    
+    if (record.magic != ACFS_QUEUE_RECORD_MAGIC || record.size > payload - offset - sizeof(record)) {
+        return ACFS_ERROR_DATA_CORRUPTED;
+    }
+    
+    if (acfs->storage->ops.read(addr + sizeof(record), data, record.size) != 0) {
+        return ACFS_ERROR_IO_ERROR;
+    }
+    
+    if (acfs_crc32(data, record.size) != record.crc32) {
+        return ACFS_ERROR_CRC_MISMATCH;
+    }
+    
+    header->head_cluster = cluster;
+    header->head_offset = offset + sizeof(record) + record.size;
+    header->count--;
+    *size = record.size;
+    return ACFS_OK;
+}
+
+/**
+ * 回收队首之前已读完的簇，grow为true时在队尾追加一簇；只提交一次元数据
+ */
+static acfs_error_t acfs_queue_resize(acfs_t* acfs, acfs_data_entry_t* entry, uint32_t head_cluster, bool grow)
+{
+    uint16_t drop = (uint16_t)(head_cluster - entry->aux);
+    if (drop == 0 && !grow) {
+        return ACFS_OK;
+    }
+    
+    uint16_t count = entry->cluster_count - drop + (grow ? 1 : 0);
+    uint16_t* list = (uint16_t*)malloc(count * sizeof(uint16_t));
+    if (!list) {
+        return ACFS_ERROR_NO_SPACE;
+    }
+    
+    uint16_t slot = (uint16_t)(entry - acfs->entries);
+    list[0] = entry->cluster_list[0];
+    memcpy(list + 1, entry->cluster_list + 1 + drop, (entry->cluster_count - 1 - drop) * sizeof(uint16_t));
+    if (grow) {
+        acfs_error_t ret = acfs_allocate_clusters(acfs, 1, &list[count - 1], slot);
+        if (ret != ACFS_OK) {
+            free(list);
+            return ret;
+        }
+    }
+    
+    acfs_free_clusters(acfs, entry->cluster_list + 1, drop);
+    free(entry->cluster_list);
+    entry->cluster_list = list;
+    entry->cluster_count = count;
+    entry->aux += drop;
+    for (uint16_t i = 0; i < count; i++) {
+        acfs->cluster_owner[list[i]].index = i;
+    }
+    
+    entry->data_size = (size_t)count * acfs_cluster_payload(acfs);
+    acfs->header.sequence++;
+    entry->mod_seq = acfs->header.sequence;
+    return acfs_commit_metadata(acfs);
+}
+
+/**
+ * 校验队列头和全部未出队的消息
+ */
+static acfs_error_t acfs_queue_check(acfs_t* acfs, const acfs_data_entry_t* entry)
+{
+    acfs_queue_header_t header;
+    acfs_error_t ret = acfs_queue_load(acfs, entry, &header);
+    
+    while (ret == ACFS_OK && header.count > 0) {
+        uint16_t size;
+        ret = acfs_queue_take(acfs, entry, &header, acfs->cluster_buffer, &size);
+    }
+    
+    if (ret != ACFS_OK && ret != ACFS_ERROR_IO_ERROR) {
+        return ACFS_ERROR_DATA_CORRUPTED;
+    }
+    return ret;
+}
+
+/**
+ * 读取计数器簇，求出当前值和日志末尾偏移
+ * 只累加属于当前基值generation的记录，压缩中断时残留的旧记录被忽略
+ */
+static acfs_error_t acfs_counter_scan(acfs_t* acfs, const acfs_data_entry_t* entry, acfs_counter_base_t* base,
+                                      uint64_t* value, uint16_t* log_end)
+{
+    uint16_t payload = acfs_cluster_payload(acfs);
+    uint32_t addr = acfs->storage->start_addr + entry->cluster_list[0] * acfs->header.cluster_size;
+    if (acfs->storage->ops.read(addr, acfs->cluster_buffer, payload) != 0) {
+        return ACFS_ERROR_IO_ERROR;
+    }
+    
+    bool found = false;
+    for (int i = 0; i < 2; i++) {
+        acfs_counter_base_t copy;
+        memcpy(&copy, acfs->cluster_buffer + i * ACFS_COUNTER_BASE_SLOT, sizeof(copy));
+        if (copy.magic != ACFS_COUNTER_MAGIC ||
+            copy.crc32 != acfs_crc32(&copy, sizeof(acfs_counter_base_t) - sizeof(uint32_t))) {
+            continue;
+        }
+        if (!found || copy.generation > base->generation) {
+            *base = copy;
+            found = true;
+        }
+    }
+    
+    if (!found) {
+        return ACFS_ERROR_DATA_CORRUPTED;
+    }
+    
+    *value = base->value;
+    uint16_t offset = ACFS_COUNTER_LOG_OFFSET;
+    while (offset + sizeof(acfs_counter_record_t) <= payload) {
+        acfs_counter_record_t record;
+        memcpy(&record, acfs->cluster_buffer + offset, sizeof(record));
+        if (record.delta == 0xFFFFFFFF && record.check == 0xFFFFFFFF) {
+            break;
+        }
+        
+        uint32_t check[2] = { record.delta, base->generation };
+        if (record.check == acfs_crc32(check, sizeof(check))) {
+            *value += record.delta;
+        }
+        offset += sizeof(record);
+    }
+    
+    *log_end = offset;
+    return ACFS_OK;
+}
+
+/**
+ * 把计数值写入较旧的基值槽，再清空日志区
+ * 清空前中断时新基值已生效，旧日志记录的generation不符而被忽略
+ */
+static acfs_error_t acfs_counter_compact(acfs_t* acfs, const acfs_data_entry_t* entry, acfs_counter_base_t* base,
+                                         uint64_t value)
+{
+    base->magic = ACFS_COUNTER_MAGIC;
+    base->generation++;
+    base->value = value;
+    base->crc32 = acfs_crc32(base, sizeof(acfs_counter_base_t) - sizeof(uint32_t));
+    
+    uint32_t addr = acfs->storage->start_addr + entry->cluster_list[0] * acfs->header.cluster_size;
+    if (acfs->storage->ops.write(addr + (base->generation % 2) * ACFS_COUNTER_BASE_SLOT,
+                                 base, sizeof(acfs_counter_base_t)) != 0) {
+        return ACFS_ERROR_IO_ERROR;
+    }
+    
+    uint16_t log_size = acfs_cluster_payload(acfs) - ACFS_COUNTER_LOG_OFFSET;
+    memset(acfs->cluster_buffer, 0xFF, log_size);
+    if (acfs->storage->ops.write(addr + ACFS_COUNTER_LOG_OFFSET, acfs->cluster_buffer, log_size) != 0) {
+        return ACFS_ERROR_IO_ERROR;
+    }
+    
+    return ACFS_OK;
+}
+
+/**
+ * 为条目复制一份独占的簇（写时复制），用于就地修改与快照或导出共享的数据
+ */
+static acfs_error_t acfs_unshare_entry(acfs_t* acfs, acfs_data_entry_t* entry)
+{
+    uint16_t* list = (uint16_t*)malloc(entry->cluster_count * sizeof(uint16_t));
+    if (!list) {
+        return ACFS_ERROR_NO_SPACE;
+    }
+    
+    acfs_error_t ret = acfs_allocate_clusters(acfs, entry->cluster_count, list, (uint16_t)(entry - acfs->entries));
+    if (ret != ACFS_OK) {
+        free(list);
+        return ret;
+    }
+    
+    for (uint16_t i = 0; i < entry->cluster_count; i++) {
+        uint32_t src = acfs->storage->start_addr + entry->cluster_list[i] * acfs->header.cluster_size;
+        uint32_t dst = acfs->storage->start_addr + list[i] * acfs->header.cluster_size;
+        if (acfs->storage->ops.read(src, acfs->cluster_buffer, acfs->header.cluster_size) != 0 ||
+            acfs->storage->ops.write(dst, acfs->cluster_buffer, acfs->header.cluster_size) != 0) {
+            acfs_free_clusters(acfs, list, entry->cluster_count);
+            free(list);
+            return ACFS_ERROR_IO_ERROR;
+        }
+    }
+    
+    // 旧簇只剩共享方的引用
+    acfs_free_clusters(acfs, entry->cluster_list, entry->cluster_count);
+    free(entry->cluster_list);
+    entry->cluster_list = list;
+    
+    return acfs_commit_metadata(acfs);
+}
+
+/**
+ * 缓存模式下为写入腾出空间
+ * 按CLOCK算法近似LRU淘汰：扫描到访问过的条目时清除其标记并跳过，
+ * 未访问过的或已过期的条目被淘汰，直到簇和条目槽位都够用。
+ * 淘汰结果随本次写入一起提交。
+ */
+static acfs_error_t acfs_cache_make_room(acfs_t* acfs, const char* data_id, size_t size)
+{
+    uint16_t clusters_needed = acfs_calculate_clusters_needed(acfs_cluster_payload(acfs), size);
+    if (clusters_needed > acfs->header.total_clusters - acfs->header.sys_clusters) {
+        return ACFS_ERROR_NO_SPACE;
+    }
+    
+    // 覆盖写入时，原数据独占的簇可以复用
+    acfs_data_entry_t* existing = acfs_find_entry(acfs, data_id);
+    uint16_t reusable = 0;
+    if (existing && existing->is_valid) {
+        for (uint16_t i = 0; i < existing->cluster_count; i++) {
+            if (acfs->cluster_refs[existing->cluster_list[i]] == 1) {
+                reusable++;
+            }
+        }
+    }
+    
+    // 新名称需要槽位：条目表已满且没有可清除的删除标记时也要淘汰
+    uint16_t max_entries = (acfs->header.sys_clusters * acfs->header.cluster_size - sizeof(acfs_header_t)) / sizeof(acfs_data_entry_t);
+    bool need_slot = false;
+    if (!existing && acfs->header.data_entries >= max_entries) {
+        need_slot = true;
+        for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
+            if (!acfs->entries[i].is_valid) {
+                need_slot = false;
+                break;
+            }
+        }
+    }
+    
+    uint16_t evicted = 0;
+    uint32_t steps = 0;
+    uint32_t max_steps = 2 * (uint32_t)acfs->header.data_entries;
+    
+    while ((acfs->header.free_clusters + reusable < clusters_needed || need_slot) && steps < max_steps) {
+        if (acfs->clock_hand >= acfs->header.data_entries) {
+            acfs->clock_hand = 0;
+        }
+        uint16_t slot = acfs->clock_hand++;
+        acfs_data_entry_t* entry = &acfs->entries[slot];
+        steps++;
+        
+        if (!entry->is_valid || entry == existing) {
+            continue;
+        }
+        
+        // 固定在值缓存中的数据不淘汰，已过期的除外
+        bool expired = acfs_entry_expired(acfs, entry);
+        if (!expired && acfs->value_cache && acfs->value_cache[slot] && acfs->value_cache[slot]->pinned) {
+            continue;
+        }
+        
+        // 第二次机会
+        if (entry->referenced && !expired) {
+            entry->referenced = 0;
+            continue;
+        }
+        
+        acfs->header.sequence++;
+        acfs_error_t ret = acfs_remove_entry(acfs, entry);
+        if (ret != ACFS_OK) {
+            return ret;
+        }
+        acfs_log_change(acfs, ACFS_CHANGE_DELETE, entry->data_id, entry->type, 0, 0);
+        evicted++;
+        need_slot = false;
+    }
+    
+    if (acfs->header.free_clusters + reusable < clusters_needed || need_slot) {
+        // 仍放不下（如空间被快照占用），提交已做的淘汰
+        if (evicted > 0) {
+            acfs_commit_metadata(acfs);
+        }
+        return ACFS_ERROR_NO_SPACE;
+    }
+    
+    return ACFS_OK;
+}
+
+/**
+ * 追加变更记录，日志满时覆盖最旧的记录
+ */
+static void acfs_log_change(acfs_t* acfs, uint8_t op, const char* data_id, uint8_t type,
+                            uint32_t data_size, uint32_t crc32)
+{
+    if (acfs->change_log_capacity == 0) {
+        // 未启用变更日志，历史一律不可追溯
+        acfs->change_log_floor = acfs->header.sequence;
+        return;
+    }
+    
+    uint16_t pos;
+    if (acfs->change_log_count < acfs->change_log_capacity) {
+        pos = (acfs->change_log_head + acfs->change_log_count) % acfs->change_log_capacity;
+        acfs->change_log_count++;
+    } else {
+        pos = acfs->change_log_head;
+        acfs->change_log_floor = acfs->change_log[pos].sequence;
+        acfs->change_log_head = (acfs->change_log_head + 1) % acfs->change_log_capacity;
+    }
+    
+    acfs_change_record_t* record = &acfs->change_log[pos];
+    record->sequence = acfs->header.sequence;
+    record->op = op;
+    record->type = type;
+    memcpy(record->data_id, data_id, ACFS_MAX_DATA_ID_LEN);
+    record->data_size = data_size;
+    record->crc32 = crc32;
+}
+
+/**
+ * 条目移动到新槽位后，更新其所有簇的反向映射
+ */
+static void acfs_set_owner_slot(acfs_t* acfs, uint16_t slot)
+{
+    acfs_data_entry_t* entry = &acfs->entries[slot];
+    for (uint16_t i = 0; i < entry->cluster_count; i++) {
+        acfs->cluster_owner[entry->cluster_list[i]].slot = slot;
+    }
+}
+
+static acfs_data_entry_t* acfs_find_entry(acfs_t* acfs, const char* data_id)
+{
+    if (acfs->name_index_dirty) {
+        // 条目增删或移动后重建名称索引，容量为条目表上限的两倍以上
+        if (!acfs->name_index) {
+            uint16_t max_entries = (acfs->header.sys_clusters * acfs->header.cluster_size - sizeof(acfs_header_t)) / sizeof(acfs_data_entry_t);
+            uint32_t capacity = 4;
+            while (capacity < 2 * (uint32_t)max_entries) {
+                capacity <<= 1;
+            }
+            acfs->name_index = (uint16_t*)malloc(capacity * sizeof(uint16_t));
+            acfs->name_index_mask = (uint16_t)(capacity - 1);
+        }
+        
+        if (acfs->name_index) {
+            memset(acfs->name_index, 0, ((uint32_t)acfs->name_index_mask + 1) * sizeof(uint16_t));
+            for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
+                if (!acfs->entries[i].is_valid) {
+                    continue;
+                }
+                uint32_t h = acfs_crc32(acfs->entries[i].data_id, strlen(acfs->entries[i].data_id)) & acfs->name_index_mask;
+                while (acfs->name_index[h]) {
+                    h = (h + 1) & acfs->name_index_mask;
+                }
+                acfs->name_index[h] = i + 1;
+            }
+            acfs->name_index_dirty = false;
+        }
+    }
+    
+    if (acfs->name_index && !acfs->name_index_dirty) {
+        uint32_t h = acfs_crc32(data_id, strlen(data_id)) & acfs->name_index_mask;
+        while (acfs->name_index[h]) {
+            acfs_data_entry_t* entry = &acfs->entries[acfs->name_index[h] - 1];
+            if (strncmp(entry->data_id, data_id, ACFS_MAX_DATA_ID_LEN) == 0) {
+                return entry;
+            }
+            h = (h + 1) & acfs->name_index_mask;
+        }
+        return NULL;
+    }
+    
+    // 索引内存不足时退回顺序查找
+    for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
+        if (acfs->entries[i].is_valid && 
+            strncmp(acfs->entries[i].data_id, data_id, ACFS_MAX_DATA_ID_LEN) == 0) {
+            return &acfs->entries[i];
+        }
+    }
+    return NULL;
+}
+
+static uint16_t acfs_calculate_clusters_needed(uint16_t cluster_size, size_t data_size)
+{
+    return (data_size + cluster_size - 1) / cluster_size;
+}
+
+/**
+ * 每簇可存放的数据字节数（启用簇尾部时扣除尾部）
+ */
+static uint16_t acfs_cluster_payload(const acfs_t* acfs)
+{
+    if (acfs->header.flags & ACFS_FLAG_CLUSTER_TRAILER) {
+        return acfs->header.cluster_size - sizeof(acfs_cluster_trailer_t);
+    }
+    return acfs->header.cluster_size;
+}
+
+static acfs_error_t acfs_read_clusters(acfs_t* acfs, const acfs_data_entry_t* entry, void* data)
+{
+    return acfs_read_range(acfs, entry, (uint8_t*)data, 0, entry->cluster_count);
+}
+
+/**
+ * 读取第first簇起的count簇，数据放在data中对应的偏移处
+ */
+static acfs_error_t acfs_read_range(acfs_t* acfs, const acfs_data_entry_t* entry, uint8_t* data,
+                                    uint16_t first, uint16_t count)
+{
+    uint16_t payload = acfs_cluster_payload(acfs);
+    size_t skip = (size_t)first * payload;
+    if (skip >= entry->data_size) {
+        return ACFS_OK;
+    }
+    uint8_t* data_ptr = data + skip;
+    size_t remaining = entry->data_size - skip;
+    
+    for (uint16_t i = first; i < first + count && remaining > 0; i++) {
+        uint32_t addr = acfs->storage->start_addr + entry->cluster_list[i] * acfs->header.cluster_size;
+        size_t chunk = remaining < payload ? remaining : payload;
+        
+        if (chunk == acfs->header.cluster_size) {
+            // 整簇直接读入用户缓冲区
+            if (acfs->storage->ops.read(addr, data_ptr, chunk) != 0) {
+                return ACFS_ERROR_IO_ERROR;
+            }
+        } else {
+            // 末簇或带尾部的簇经簇缓冲区中转
+            if (acfs->storage->ops.read(addr, acfs->cluster_buffer, acfs->header.cluster_size) != 0) {
+                return ACFS_ERROR_IO_ERROR;
+            }
+            memcpy(data_ptr, acfs->cluster_buffer, chunk);
+        }
+        
+        data_ptr += chunk;
+        remaining -= chunk;
+    }
+    
+    return ACFS_OK;
+}
+
+/**
+ * 把多个数据段顺序写入条目的簇
+ * 簇内容完整落在一个数据段内时直接从数据段写入，跨数据段的簇先在簇缓冲区中拼接
+ */
+static acfs_error_t acfs_write_segments(acfs_t* acfs, const acfs_data_entry_t* entry,
+                                        const acfs_iovec_t* iov, uint16_t iovcnt)
+{
+    return acfs_write_range(acfs, entry, iov, iovcnt, 0, entry->cluster_count);
+}
+
+/* 流水线的一级：一个工作项计算一段数据的CRC，另一个同时读写另一段簇 */
+typedef struct {
+    acfs_t* acfs;
+    const acfs_data_entry_t* entry;
+    const acfs_iovec_t* iov;        // 写入的数据段，读取时为NULL
+    uint16_t iovcnt;
+    uint8_t* data;                  // 读取的目标缓冲区，写入时为NULL
+    uint16_t crc_first;             // 本级计算CRC的首簇
+    uint16_t crc_count;             // 本级计算CRC的簇数，0表示无
+    uint16_t io_first;              // 本级读写的首簇
+    uint16_t io_count;              // 本级读写的簇数，0表示无
+    uint32_t crc;                   // 累计的CRC
+    acfs_error_t result;            // 读写结果
+} acfs_pipeline_t;
+
+static void acfs_pipeline_task(void* arg, uint32_t index, uint16_t worker)
+{
+    acfs_pipeline_t* stage = (acfs_pipeline_t*)arg;
+    acfs_t* acfs = stage->acfs;
+    uint16_t payload = acfs_cluster_payload(acfs);
+    (void)worker;
+    
+    if (index == 1) {
+        if (stage->io_count == 0) {
+            return;
+        }
+        if (stage->data) {
+            stage->result = acfs_read_range(acfs, stage->entry, stage->data, stage->io_first, stage->io_count);
+        } else {
+            stage->result = acfs_write_range(acfs, stage->entry, stage->iov, stage->iovcnt,
+                                             stage->io_first, stage->io_count);
+        }
+        return;
+    }
+    
+    if (stage->crc_count == 0) {
+        return;
+    }
+    size_t offset = (size_t)stage->crc_first * payload;
+    size_t length = (size_t)stage->crc_count * payload;
+    if (length > stage->entry->data_size - offset) {
+        length = stage->entry->data_size - offset;
+    }
+    
+    if (stage->data) {
+        stage->crc = acfs_crc32_update(stage->crc, stage->data + offset, length);
+        return;
+    }
+    
+    // 在各数据段中定位这一段
+    for (uint16_t i = 0; i < stage->iovcnt && length > 0; i++) {
+        if (offset >= stage->iov[i].size) {
+            offset -= stage->iov[i].size;
+            continue;
+        }
+        size_t part = stage->iov[i].size - offset;
+        if (part > length) {
+            part = length;
+        }
+        stage->crc = acfs_crc32_update(stage->crc, (const uint8_t*)stage->iov[i].data + offset, part);
+        length -= part;
+        offset = 0;
+    }
+}
+
+/**
+ * 配置了至少两个工作线程的执行器、且数据超过一级时，读写按流水线进行
+ */
+static bool acfs_pipeline_enabled(const acfs_t* acfs, const acfs_data_entry_t* entry)
+{
+    return acfs->executor && acfs->executor->workers >= 2 && entry->cluster_count > ACFS_PIPELINE_CLUSTERS;
+}
+
+/**
+ * 流水线写入：第k级计算第k段的CRC，同时写入第k-1段；
+ * 末簇尾部记录整条数据的CRC，因此最后一段在全部CRC算完后的一级写入
+ */
+static acfs_error_t acfs_write_pipelined(acfs_t* acfs, acfs_data_entry_t* entry,
+                                         const acfs_iovec_t* iov, uint16_t iovcnt)
+{
+    uint16_t stages = (entry->cluster_count + ACFS_PIPELINE_CLUSTERS - 1) / ACFS_PIPELINE_CLUSTERS;
+    acfs_pipeline_t stage;
+    memset(&stage, 0, sizeof(stage));
+    stage.acfs = acfs;
+    stage.entry = entry;
+    stage.iov = iov;
+    stage.iovcnt = iovcnt;
+    stage.crc = acfs_crc32_init();
+    
+    for (uint16_t k = 0; k <= stages; k++) {
+        stage.crc_count = 0;
+        if (k < stages) {
+            stage.crc_first = k * ACFS_PIPELINE_CLUSTERS;
+            stage.crc_count = entry->cluster_count - stage.crc_first;
+            if (stage.crc_count > ACFS_PIPELINE_CLUSTERS) {
+                stage.crc_count = ACFS_PIPELINE_CLUSTERS;
+            }
+        } else {
+            entry->crc32 = acfs_crc32_finalize(stage.crc);
+        }
+        
+        stage.io_count = 0;
+        if (k > 0) {
+            stage.io_first = (k - 1) * ACFS_PIPELINE_CLUSTERS;
+            stage.io_count = entry->cluster_count - stage.io_first;
+            if (stage.io_count > ACFS_PIPELINE_CLUSTERS) {
+                stage.io_count = ACFS_PIPELINE_CLUSTERS;
+            }
+        }
+        
+        acfs_parallel_for(acfs, acfs_pipeline_task, &stage, 2);
+        if (stage.result != ACFS_OK) {
+            return stage.result;
+        }
+    }
+    
+    return ACFS_OK;
+}
+
+/**
+ * 读取数据并校验CRC；走流水线时第k级读取第k段，同时校验第k-1段
+ */
+static acfs_error_t acfs_read_verified(acfs_t* acfs, const acfs_data_entry_t* entry, uint8_t* data)
+{
+    if (!acfs_pipeline_enabled(acfs, entry)) {
+        acfs_error_t ret = acfs_read_clusters(acfs, entry, data);
+        if (ret != ACFS_OK) {
+            return ret;
+        }
+        if (acfs_crc32(data, entry->data_size) != entry->crc32) {
+            return ACFS_ERROR_CRC_MISMATCH;
+        }
+        return ACFS_OK;
+    }
+    
+    uint16_t stages = (entry->cluster_count + ACFS_PIPELINE_CLUSTERS - 1) / ACFS_PIPELINE_CLUSTERS;
+    acfs_pipeline_t stage;
+    memset(&stage, 0, sizeof(stage));
+    stage.acfs = acfs;
+    stage.entry = entry;
+    stage.data = data;
+    stage.crc = acfs_crc32_init();
+    
+    for (uint16_t k = 0; k <= stages; k++) {
+        stage.io_count = 0;
+        if (k < stages) {
+            stage.io_first = k * ACFS_PIPELINE_CLUSTERS;
+            stage.io_count = entry->cluster_count - stage.io_first;
+            if (stage.io_count > ACFS_PIPELINE_CLUSTERS) {
+                stage.io_count = ACFS_PIPELINE_CLUSTERS;
+            }
+        }
+        
+        stage.crc_count = 0;
+        if (k > 0) {
+            stage.crc_first = (k - 1) * ACFS_PIPELINE_CLUSTERS;
+            stage.crc_count = entry->cluster_count - stage.crc_first;
+            if (stage.crc_count > ACFS_PIPELINE_CLUSTERS) {
+                stage.crc_count = ACFS_PIPELINE_CLUSTERS;
+            }
+        }
+        
+        acfs_parallel_for(acfs, acfs_pipeline_task, &stage, 2);
+        if (stage.result != ACFS_OK) {
+            return stage.result;
+        }
+    }
+    
+    if (acfs_crc32_finalize(stage.crc) != entry->crc32) {
+        return ACFS_ERROR_CRC_MISMATCH;
+    }
+    return ACFS_OK;
+}
+
+/**
+ * 把各数据段拼接后的第first簇起的count簇写入存储
+ */
+static acfs_error_t acfs_write_range(acfs_t* acfs, const acfs_data_entry_t* entry,
+                                     const acfs_iovec_t* iov, uint16_t iovcnt, uint16_t first, uint16_t count)
+{
+    uint16_t payload = acfs_cluster_payload(acfs);
+    size_t skip = (size_t)first * payload;
+    size_t remaining = entry->data_size - skip;
+    uint16_t seg = 0;
+    size_t seg_offset = 0;
+    
+    // 定位到首簇所在的数据段
+    while (skip > 0) {
+        size_t part = iov[seg].size - seg_offset;
+        if (part > skip) {
+            part = skip;
+        }
+        seg_offset += part;
+        skip -= part;
+        if (seg_offset == iov[seg].size) {
+            seg++;
+            seg_offset = 0;
+        }
+    }
+    
+    for (uint16_t i = first; i < first + count; i++) {
+        size_t chunk = remaining < payload ? remaining : payload;
+        
+        // 跳过已写完和空的数据段
+        while (seg < iovcnt && seg_offset == iov[seg].size) {
+            seg++;
+            seg_offset = 0;
+        }
+        
+        const uint8_t* src;
+        if (iov[seg].size - seg_offset >= chunk) {
+            src = (const uint8_t*)iov[seg].data + seg_offset;
+            seg_offset += chunk;
+        } else {
+            size_t filled = 0;
+            while (filled < chunk) {
+                if (seg_offset == iov[seg].size) {
+                    seg++;
+                    seg_offset = 0;
+                    continue;
+                }
+                size_t part = iov[seg].size - seg_offset;
+                if (part > chunk - filled) {
+                    part = chunk - filled;
+                }
+                memcpy(acfs->cluster_buffer + filled, (const uint8_t*)iov[seg].data + seg_offset, part);
+                filled += part;
+                seg_offset += part;
+            }
+            src = acfs->cluster_buffer;
+        }
+        
+        acfs_error_t ret = acfs_write_cluster(acfs, entry, i, src, chunk);
+        if (ret != ACFS_OK) {
+            return ret;
+        }
+        
+        remaining -= chunk;
+    }
+    
+    return ACFS_OK;
+}
+
+/**
+ * 写入条目的第index个簇，chunk不超过每簇有效载荷
+ */
+static acfs_error_t acfs_write_cluster(acfs_t* acfs, const acfs_data_entry_t* entry, uint16_t index,
+                                       const uint8_t* chunk, size_t chunk_size)
+{
+    uint32_t addr = acfs->storage->start_addr + entry->cluster_list[index] * acfs->header.cluster_size;
+    
+    if (chunk_size == acfs->header.cluster_size) {
+        // 整簇直接从调用方数据写入
+        if (acfs->storage->ops.write(addr, chunk, chunk_size) != 0) {
+            return ACFS_ERROR_IO_ERROR;
+        }
+        return ACFS_OK;
+    }
+    
+    // 末簇不足部分补零，启用时追加簇尾部
+    uint16_t payload = acfs_cluster_payload(acfs);
+    memmove(acfs->cluster_buffer, chunk, chunk_size);
+    memset(acfs->cluster_buffer + chunk_size, 0, acfs->header.cluster_size - chunk_size);
+    if (acfs->header.flags & ACFS_FLAG_CLUSTER_TRAILER) {
+        acfs_fill_trailer(acfs, entry, index, acfs->cluster_buffer,
+                          (acfs_cluster_trailer_t*)(acfs->cluster_buffer + payload));
+    }
+    if (acfs->storage->ops.write(addr, acfs->cluster_buffer, acfs->header.cluster_size) != 0) {
+        return ACFS_ERROR_IO_ERROR;
+    }
+    
+    return ACFS_OK;
+}
+
+/**
+ * 向导出流写入数据并累计流CRC（crc为NULL时不累计）
+ */
+static acfs_error_t acfs_stream_put(acfs_stream_write_t write_cb, void* user_data,
+                                    const void* data, size_t size, uint32_t* crc)
+{
+    if (write_cb(data, size, user_data) != 0) {
+        return ACFS_ERROR_IO_ERROR;
+    }
+    
+    if (crc) {
+        *crc = acfs_crc32_update(*crc, data, size);
+    }
+    return ACFS_OK;
+}
+
+/**
+ * 从导入流读取数据并累计流CRC（crc为NULL时不累计）
+ */
+static acfs_error_t acfs_stream_get(acfs_stream_read_t read_cb, void* user_data,
+                                    void* data, size_t size, uint32_t* crc)
+{
+    if (read_cb(data, size, user_data) != 0) {
+        return ACFS_ERROR_IO_ERROR;
+    }
+    
+    if (crc) {
+        *crc = acfs_crc32_update(*crc, data, size);
+    }
+    return ACFS_OK;
+}
+
+/**
+ * 生成簇尾部，CRC覆盖有效载荷和尾部其余字段
+ */
+static void acfs_fill_trailer(acfs_t* acfs, const acfs_data_entry_t* entry, uint16_t index,
+                              const uint8_t* payload, acfs_cluster_trailer_t* trailer)
+{
+    bool last = (index == entry->cluster_count - 1);
+    
+    trailer->magic = ACFS_TRAILER_MAGIC;
+    trailer->index = index;
+    trailer->owner_hash = entry->owner_hash;
+    trailer->sequence = acfs->header.sequence;
+    trailer->data_size = last ? entry->data_size : 0;
+    trailer->data_crc = last ? entry->crc32 : 0;
+    
+    uint32_t crc = acfs_crc32_update(acfs_crc32_init(), payload, acfs_cluster_payload(acfs));
+    crc = acfs_crc32_update(crc, trailer, sizeof(acfs_cluster_trailer_t) - sizeof(uint32_t));
+    trailer->crc32 = acfs_crc32_finalize(crc);
+}
+
+/**
+ * 在末簇尾部写入删除标记（只写尾部，CRC仅覆盖尾部）
+ */
+static acfs_error_t acfs_mark_deleted(acfs_t* acfs, const acfs_data_entry_t* entry)
+{
+    if (!(acfs->header.flags & ACFS_FLAG_CLUSTER_TRAILER) || entry->cluster_count == 0) {
+        return ACFS_OK;
+    }
+    
+    // 末簇仍被快照或导出引用时保留其尾部，快照回滚后还要用
+    if (acfs->cluster_refs[entry->cluster_list[entry->cluster_count - 1]] > 1) {
+        return ACFS_OK;
+    }
+    
+    acfs_cluster_trailer_t trailer;
+    trailer.magic = ACFS_TRAILER_MAGIC_DELETED;
+    trailer.index = entry->cluster_count - 1;
+    trailer.owner_hash = entry->owner_hash;
+    trailer.sequence = acfs->header.sequence;
+    trailer.data_size = 0;
+    trailer.data_crc = 0;
+    trailer.crc32 = acfs_crc32(&trailer, sizeof(acfs_cluster_trailer_t) - sizeof(uint32_t));
+    
+    uint32_t addr = acfs->storage->start_addr +
+                    entry->cluster_list[entry->cluster_count - 1] * acfs->header.cluster_size +
+                    acfs_cluster_payload(acfs);
+    if (acfs->storage->ops.write(addr, &trailer, sizeof(trailer)) != 0) {
+        return ACFS_ERROR_IO_ERROR;
+    }
+    
+    return ACFS_OK;
+}
+
+/**
+ * 以当前序列号重写条目各簇的有效尾部，使元数据重建时它们新于同一条目被丢弃的版本
+ */
+static acfs_error_t acfs_restamp_trailers(acfs_t* acfs, const acfs_data_entry_t* entry)
+{
+    if (!(acfs->header.flags & ACFS_FLAG_CLUSTER_TRAILER)) {
+        return ACFS_OK;
+    }
+    
+    uint16_t payload = acfs_cluster_payload(acfs);
+    for (uint16_t k = 0; k < entry->cluster_count; k++) {
+        uint32_t addr = acfs->storage->start_addr + entry->cluster_list[k] * acfs->header.cluster_size;
+        if (acfs->storage->ops.read(addr, acfs->cluster_buffer, acfs->header.cluster_size) != 0) {
+            return ACFS_ERROR_IO_ERROR;
+        }
+        
+        acfs_cluster_trailer_t trailer;
+        memcpy(&trailer, acfs->cluster_buffer + payload, sizeof(trailer));
+        uint32_t crc = acfs_crc32_update(acfs_crc32_init(), acfs->cluster_buffer, payload);
+        crc = acfs_crc32_update(crc, &trailer, sizeof(trailer) - sizeof(uint32_t));
+        if (trailer.magic != ACFS_TRAILER_MAGIC || acfs_crc32_finalize(crc) != trailer.crc32) {
+            continue;
+        }
+        
+        trailer.sequence = acfs->header.sequence;
+        crc = acfs_crc32_update(acfs_crc32_init(), acfs->cluster_buffer, payload);
+        crc = acfs_crc32_update(crc, &trailer, sizeof(trailer) - sizeof(uint32_t));
+        trailer.crc32 = acfs_crc32_finalize(crc);
+        if (acfs->storage->ops.write(addr + payload, &trailer, sizeof(trailer)) != 0) {
+            return ACFS_ERROR_IO_ERROR;
+        }
+    }
+    
+    return ACFS_OK;
+}
+
+/* 并行校验的共享参数 */
+typedef struct {
+    acfs_t* acfs;
+    uint8_t* buffers;               // 每个工作线程一个簇缓冲区
+    acfs_error_t* results;          // 按条目槽位记录的校验结果
+} acfs_scrub_job_t;
+
+/**
+ * 逐簇读取普通数据并校验CRC，只使用调用者提供的簇缓冲区，可在多个线程中同时执行
+ */
+static acfs_error_t acfs_scrub_entry(acfs_t* acfs, const acfs_data_entry_t* entry, uint8_t* buffer)
+{
+    uint16_t payload = acfs_cluster_payload(acfs);
+    size_t remaining = entry->data_size;
+    uint32_t crc = acfs_crc32_init();
+    
+    for (uint16_t i = 0; i < entry->cluster_count && remaining > 0; i++) {
+        uint32_t addr = acfs->storage->start_addr + entry->cluster_list[i] * acfs->header.cluster_size;
+        size_t chunk = remaining < payload ? remaining : payload;
+        if (acfs->storage->ops.read(addr, buffer, chunk) != 0) {
+            return ACFS_ERROR_IO_ERROR;
+        }
+        crc = acfs_crc32_update(crc, buffer, chunk);
+        remaining -= chunk;
+    }
+    
+    if (acfs_crc32_finalize(crc) != entry->crc32) {
+        return ACFS_ERROR_DATA_CORRUPTED;
+    }
+    return ACFS_OK;
+}
+
+static void acfs_scrub_task(void* arg, uint32_t index, uint16_t worker)
+{
+    acfs_scrub_job_t* job = (acfs_scrub_job_t*)arg;
+    const acfs_data_entry_t* entry = &job->acfs->entries[index];
+    
+    job->results[index] = ACFS_OK;
+    if (entry->is_valid && entry->type == ACFS_TYPE_VALUE) {
+        job->results[index] = acfs_scrub_entry(job->acfs, entry,
+                                               job->buffers + (size_t)worker * job->acfs->header.cluster_size);
+    }
+}
+
+/**
+ * 通过执行器执行count个工作项，未配置执行器时在调用线程中依次执行
+ */
+static void acfs_parallel_for(acfs_t* acfs, acfs_task_t task, void* arg, uint32_t count)
+{
+    if (acfs->executor) {
+        acfs->executor->parallel_for(acfs->executor->context, task, arg, count);
+        return;
+    }
+    
+    for (uint32_t i = 0; i < count; i++) {
+        task(arg, i, 0);
+    }
+}
+
+acfs_error_t acfs_check_integrity(acfs_t* acfs)
+{
+    if (!acfs || !acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (acfs->header.data_entries == 0) {
+        return ACFS_OK;
+    }
+    
+    // 普通数据的CRC校验互不依赖，交给执行器并行进行
+    uint16_t workers = acfs->executor ? acfs->executor->workers : 1;
+    acfs_scrub_job_t job;
+    job.acfs = acfs;
+    job.buffers = (uint8_t*)malloc((size_t)workers * acfs->header.cluster_size);
+    job.results = (acfs_error_t*)malloc(acfs->header.data_entries * sizeof(acfs_error_t));
+    if (!job.buffers || !job.results) {
+        free(job.buffers);
+        free(job.results);
+        return ACFS_ERROR_NO_SPACE;
+    }
+    acfs_parallel_for(acfs, acfs_scrub_task, &job, acfs->header.data_entries);
+    
+    // 按槽位顺序报告第一个错误
+    acfs_error_t result = ACFS_OK;
+    for (uint16_t i = 0; i < acfs->header.data_entries && result == ACFS_OK; i++) {
+        acfs_data_entry_t* entry = &acfs->entries[i];
+        if (!entry->is_valid) continue;
+        
+        // 环形记录、队列和计数器共用实例的缓冲区，在调用线程中按各自的格式校验
+        switch (entry->type) {
+            case ACFS_TYPE_VALUE:
+                result = job.results[i];
+                break;
+            case ACFS_TYPE_RING:
+                result = acfs_ring_check(acfs, entry);
+                break;
+            case ACFS_TYPE_QUEUE:
+                result = acfs_queue_check(acfs, entry);
+                break;
+            default: {
+                acfs_counter_base_t base;
+                uint64_t value;
+                uint16_t log_end;
+                result = acfs_counter_scan(acfs, entry, &base, &value, &log_end);
+                break;
+            }
+        }
+    }
+    
+    free(job.buffers);
+    free(job.results);
+    return result;
+}
+
+acfs_error_t acfs_ring_create(acfs_t* acfs, const char* data_id, uint16_t record_size, uint32_t capacity)
+{
+    if (!acfs || !data_id || record_size == 0 || capacity == 0) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    // 记录就地覆盖，簇尾部的CRC无法维持
+    if (strlen(data_id) >= ACFS_MAX_DATA_ID_LEN || (acfs->header.flags & ACFS_FLAG_CLUSTER_TRAILER)) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    uint16_t payload = acfs_cluster_payload(acfs);
+    uint32_t slot_size = sizeof(acfs_ring_slot_t) + record_size;
+    if (slot_size > payload) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    acfs_data_entry_t* existing = acfs_find_entry(acfs, data_id);
+    if (existing && !acfs_entry_expired(acfs, existing)) {
+        return ACFS_ERROR_DATA_EXISTS;
+    }
+    
+    // 首簇存放环形记录头，记录不跨簇
+    uint16_t per_cluster = (uint16_t)(payload / slot_size);
+    uint32_t clusters = 1 + (capacity - 1) / per_cluster + 1;
+    uint32_t data_clusters = (uint32_t)acfs->header.total_clusters - acfs->header.sys_clusters;
+    if (clusters > data_clusters) {
+        return ACFS_ERROR_NO_SPACE;
+    }
+    size_t size = (size_t)clusters * payload;
+    
+    acfs_error_t ret;
+    if (acfs->header.flags & ACFS_FLAG_CACHE) {
+        ret = acfs_cache_make_room(acfs, data_id, size);
+        if (ret != ACFS_OK) {
+            return ret;
+        }
+    }
+    
+    acfs_data_entry_t* entry;
+    ret = acfs_prepare_entry(acfs, data_id, size, &entry);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    entry->type = ACFS_TYPE_RING;
+    entry->data_size = size;
+    entry->crc32 = 0;
+    acfs->header.sequence++;
+    entry->mod_seq = acfs->header.sequence;
+    entry->expire_at = 0;
+    
+    // 清空全部槽，旧数据中的序号不得被当作记录
+    memset(acfs->cluster_buffer, 0, acfs->header.cluster_size);
+    for (uint16_t i = 1; i < entry->cluster_count; i++) {
+        uint32_t addr = acfs->storage->start_addr + entry->cluster_list[i] * acfs->header.cluster_size;
+        if (acfs->storage->ops.write(addr, acfs->cluster_buffer, acfs->header.cluster_size) != 0) {
+            return ACFS_ERROR_IO_ERROR;
+        }
+    }
+    
+    acfs_ring_header_t* header = (acfs_ring_header_t*)acfs->cluster_buffer;
+    header->magic = ACFS_RING_MAGIC;
+    header->record_size = record_size;
+    header->per_cluster = per_cluster;
+    header->capacity = capacity;
+    header->crc32 = acfs_crc32(header, sizeof(acfs_ring_header_t) - sizeof(uint32_t));
+    uint32_t addr = acfs->storage->start_addr + entry->cluster_list[0] * acfs->header.cluster_size;
+    if (acfs->storage->ops.write(addr, acfs->cluster_buffer, acfs->header.cluster_size) != 0) {
+        return ACFS_ERROR_IO_ERROR;
+    }
+    
+    ret = acfs_commit_metadata(acfs);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    acfs_log_change(acfs, ACFS_CHANGE_WRITE, entry->data_id, entry->type, entry->data_size, entry->crc32);
+    return ACFS_OK;
+}
+
+acfs_error_t acfs_ring_push(acfs_t* acfs, const char* data_id, const void* record)
+{
+    if (!acfs || !data_id || !record) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    acfs_data_entry_t* entry;
+    acfs_error_t ret = acfs_find_typed(acfs, data_id, ACFS_TYPE_RING, true, &entry);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    acfs_ring_cursor_t* cursor;
+    ret = acfs_ring_open(acfs, entry, &cursor);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    uint32_t slot_size = sizeof(acfs_ring_slot_t) + cursor->record_size;
+    uint32_t index = (uint32_t)((cursor->next_seq - 1) % cursor->capacity);
+    uint16_t cluster = entry->cluster_list[1 + index / cursor->per_cluster];
+    uint32_t addr = acfs->storage->start_addr + cluster * acfs->header.cluster_size +
+                    (index % cursor->per_cluster) * slot_size;
+    
+    acfs_ring_slot_t* slot = (acfs_ring_slot_t*)acfs->cluster_buffer;
+    slot->seq = cursor->next_seq;
+    memcpy(acfs->cluster_buffer + sizeof(acfs_ring_slot_t), record, cursor->record_size);
+    uint32_t crc = acfs_crc32_update(acfs_crc32_init(), &slot->seq, sizeof(slot->seq));
+    crc = acfs_crc32_update(crc, record, cursor->record_size);
+    slot->crc32 = acfs_crc32_finalize(crc);
+    
+    if (acfs->storage->ops.write(addr, acfs->cluster_buffer, slot_size) != 0) {
+        return ACFS_ERROR_IO_ERROR;
+    }
+    
+    cursor->next_seq++;
+    return ACFS_OK;
+}
+
+acfs_error_t acfs_ring_read_range(acfs_t* acfs, const char* data_id, void* records,
+                                  uint32_t max_records, uint32_t* count)
+{
+    if (!acfs || !data_id || (!records && max_records > 0) || !count) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    *count = 0;
+    
+    acfs_data_entry_t* entry;
+    acfs_error_t ret = acfs_find_typed(acfs, data_id, ACFS_TYPE_RING, false, &entry);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    acfs_ring_cursor_t* cursor;
+    ret = acfs_ring_open(acfs, entry, &cursor);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    uint64_t newest = cursor->next_seq - 1;
+    uint32_t available = newest < cursor->capacity ? (uint32_t)newest : cursor->capacity;
+    uint32_t n = available < max_records ? available : max_records;
+    uint32_t slot_size = sizeof(acfs_ring_slot_t) + cursor->record_size;
+    uint8_t* out = (uint8_t*)records;
+    
+    for (uint64_t seq = newest - n + 1; seq <= newest; seq++) {
+        uint32_t index = (uint32_t)((seq - 1) % cursor->capacity);
+        uint16_t cluster = entry->cluster_list[1 + index / cursor->per_cluster];
+        uint32_t addr = acfs->storage->start_addr + cluster * acfs->header.cluster_size +
+                        (index % cursor->per_cluster) * slot_size;
+        if (acfs->storage->ops.read(addr, acfs->cluster_buffer, slot_size) != 0) {
+            return ACFS_ERROR_IO_ERROR;
+        }
+        
+        const acfs_ring_slot_t* slot = (const acfs_ring_slot_t*)acfs->cluster_buffer;
+        const uint8_t* record = acfs->cluster_buffer + sizeof(acfs_ring_slot_t);
+        uint32_t crc = acfs_crc32_update(acfs_crc32_init(), &slot->seq, sizeof(slot->seq));
+        crc = acfs_crc32_update(crc, record, cursor->record_size);
+        if (slot->seq != seq || acfs_crc32_finalize(crc) != slot->crc32) {
+            return ACFS_ERROR_CRC_MISMATCH;
+        }
+        
+        memcpy(out, record, cursor->record_size);
+        out += cursor->record_size;
+    }
+    
+    *count = n;
+    return ACFS_OK;
+}
+
+acfs_error_t acfs_queue_create(acfs_t* acfs, const char* data_id)
+{
+    if (!acfs || !data_id) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    // 消息就地追加，簇尾部的CRC无法维持
+    if (strlen(data_id) >= ACFS_MAX_DATA_ID_LEN || (acfs->header.flags & ACFS_FLAG_CLUSTER_TRAILER)) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    acfs_data_entry_t* existing = acfs_find_entry(acfs, data_id);
+    if (existing && !acfs_entry_expired(acfs, existing)) {
+        return ACFS_ERROR_DATA_EXISTS;
+    }
+    
+    // 队列头簇和一个数据簇
+    size_t size = 2 * (size_t)acfs_cluster_payload(acfs);
+    acfs_error_t ret;
+    if (acfs->header.flags & ACFS_FLAG_CACHE) {
+        ret = acfs_cache_make_room(acfs, data_id, size);
+        if (ret != ACFS_OK) {
+            return ret;
+        }
+    }
+    
+    acfs_data_entry_t* entry;
+    ret = acfs_prepare_entry(acfs, data_id, size, &entry);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    entry->type = ACFS_TYPE_QUEUE;
+    entry->data_size = size;
+    entry->crc32 = 0;
+    acfs->header.sequence++;
+    entry->mod_seq = acfs->header.sequence;
+    entry->expire_at = 0;
+    
+    // 清除旧数据中可能残留的队列头
+    memset(acfs->cluster_buffer, 0, 2 * ACFS_QUEUE_HEADER_SLOT);
+    uint32_t addr = acfs->storage->start_addr + entry->cluster_list[0] * acfs->header.cluster_size;
+    if (acfs->storage->ops.write(addr, acfs->cluster_buffer, 2 * ACFS_QUEUE_HEADER_SLOT) != 0) {
+        return ACFS_ERROR_IO_ERROR;
+    }
+    
+    acfs_queue_header_t header;
+    memset(&header, 0, sizeof(header));
+    ret = acfs_queue_store(acfs, entry, &header);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    ret = acfs_commit_metadata(acfs);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    acfs_log_change(acfs, ACFS_CHANGE_WRITE, entry->data_id, entry->type, entry->data_size, entry->crc32);
+    return ACFS_OK;
+}
+
+acfs_error_t acfs_queue_push(acfs_t* acfs, const char* data_id, const void* data, size_t size)
+{
+    if (!acfs || !data_id || !data || size == 0) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    uint16_t payload = acfs_cluster_payload(acfs);
+    if (size > payload - sizeof(acfs_queue_record_t)) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    acfs_data_entry_t* entry;
+    acfs_error_t ret = acfs_find_typed(acfs, data_id, ACFS_TYPE_QUEUE, true, &entry);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    acfs_queue_header_t header;
+    ret = acfs_queue_load(acfs, entry, &header);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    // 本簇放不下时标记剩余部分未使用，转到下一簇
+    uint32_t cluster = header.tail_cluster;
+    uint16_t offset = header.tail_offset;
+    uint16_t record_size = (uint16_t)(sizeof(acfs_queue_record_t) + size);
+    acfs_queue_record_t record;
+    
+    if (offset + record_size > payload) {
+        if ((size_t)(payload - offset) >= sizeof(acfs_queue_record_t)) {
+            record.size = 0;
+            record.magic = ACFS_QUEUE_SKIP_MAGIC;
+            record.crc32 = 0;
+            uint32_t addr = acfs->storage->start_addr +
+                            entry->cluster_list[1 + cluster - entry->aux] * acfs->header.cluster_size + offset;
+            if (acfs->storage->ops.write(addr, &record, sizeof(record)) != 0) {
+                return ACFS_ERROR_IO_ERROR;
+            }
+        }
+        cluster++;
+        offset = 0;
+    }
+    
+    // 队尾进入新簇时追加簇，顺便回收已读完的簇
+    if (cluster - entry->aux >= (uint32_t)entry->cluster_count - 1) {
+        ret = acfs_queue_resize(acfs, entry, header.head_cluster, true);
+        if (ret != ACFS_OK) {
+            return ret;
+        }
+    }
+    
+    record.size = (uint16_t)size;
+    record.magic = ACFS_QUEUE_RECORD_MAGIC;
+    record.crc32 = acfs_crc32(data, size);
+    memcpy(acfs->cluster_buffer, &record, sizeof(record));
+    memcpy(acfs->cluster_buffer + sizeof(record), data, size);
+    uint32_t addr = acfs->storage->start_addr +
+                    entry->cluster_list[1 + cluster - entry->aux] * acfs->header.cluster_size + offset;
+    if (acfs->storage->ops.write(addr, acfs->cluster_buffer, record_size) != 0) {
+        return ACFS_ERROR_IO_ERROR;
+    }
+    
+    header.tail_cluster = cluster;
+    header.tail_offset = offset + record_size;
+    header.count++;
+    return acfs_queue_store(acfs, entry, &header);
+}
+
+acfs_error_t acfs_queue_pop(acfs_t* acfs, const char* data_id, void* data, size_t size, size_t* actual_size)
+{
+    if (!acfs || !data_id || !data) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    acfs_data_entry_t* entry;
+    acfs_error_t ret = acfs_find_typed(acfs, data_id, ACFS_TYPE_QUEUE, true, &entry);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    acfs_queue_header_t header;
+    ret = acfs_queue_load(acfs, entry, &header);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    if (header.count == 0) {
+        return ACFS_ERROR_QUEUE_EMPTY;
+    }
+    
+    uint16_t message_size;
+    ret = acfs_queue_take(acfs, entry, &header, acfs->cluster_buffer, &message_size);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    if (actual_size) {
+        *actual_size = message_size;
+    }
+    
+    if (size < message_size) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    memcpy(data, acfs->cluster_buffer, message_size);
+    
+    ret = acfs_queue_store(acfs, entry, &header);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    // 队首离开的簇立即回收，每簇只提交一次元数据
+    return acfs_queue_resize(acfs, entry, header.head_cluster, false);
+}
+
+acfs_error_t acfs_queue_pop_batch(acfs_t* acfs, const char* data_id, uint32_t max_messages,
+                                  acfs_queue_callback_t callback, void* user_data, uint32_t* popped)
+{
+    if (!acfs || !data_id || !callback) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (popped) {
+        *popped = 0;
+    }
+    
+    acfs_data_entry_t* entry;
+    acfs_error_t ret = acfs_find_typed(acfs, data_id, ACFS_TYPE_QUEUE, true, &entry);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    acfs_queue_header_t header;
+    ret = acfs_queue_load(acfs, entry, &header);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    // 回调可能调用其他接口，消息不放在簇缓冲区中
+    uint8_t* buffer = (uint8_t*)malloc(acfs_cluster_payload(acfs));
+    if (!buffer) {
+        return ACFS_ERROR_NO_SPACE;
+    }
+    
+    uint32_t taken = 0;
+    while (header.count > 0 && (max_messages == 0 || taken < max_messages)) {
+        acfs_queue_header_t next = header;
+        uint16_t message_size;
+        ret = acfs_queue_take(acfs, entry, &next, buffer, &message_size);
+        if (ret != ACFS_OK) {
+            break;
+        }
+        
+        ret = callback(buffer, message_size, user_data);
+        if (ret != ACFS_OK) {
+            break;
+        }
+        
+        header = next;
+        taken++;
+    }
+    
+    free(buffer);
+    
+    // 整批只写一次队列头，一次回收全部读完的簇
+    if (taken > 0) {
+        acfs_error_t commit_ret = acfs_queue_store(acfs, entry, &header);
+        if (commit_ret == ACFS_OK) {
+            commit_ret = acfs_queue_resize(acfs, entry, header.head_cluster, false);
+        }
+        if (ret == ACFS_OK) {
+            ret = commit_ret;
+        }
+    }
+    
+    if (popped) {
+        *popped = taken;
+    }
+    return ret;
+}
+
+acfs_error_t acfs_queue_length(acfs_t* acfs, const char* data_id, uint32_t* count)
+{
+    if (!acfs || !data_id || !count) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    acfs_data_entry_t* entry;
+    acfs_error_t ret = acfs_find_typed(acfs, data_id, ACFS_TYPE_QUEUE, false, &entry);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    acfs_queue_header_t header;
+    ret = acfs_queue_load(acfs, entry, &header);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    *count = header.count;
+    return ACFS_OK;
+}
+
+acfs_error_t acfs_counter_create(acfs_t* acfs, const char* data_id, uint64_t initial)
+{
+    if (!acfs || !data_id) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    // 增量就地追加，簇尾部的CRC无法维持
+    if (strlen(data_id) >= ACFS_MAX_DATA_ID_LEN || (acfs->header.flags & ACFS_FLAG_CLUSTER_TRAILER)) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    acfs_data_entry_t* existing = acfs_find_entry(acfs, data_id);
+    if (existing && !acfs_entry_expired(acfs, existing)) {
+        return ACFS_ERROR_DATA_EXISTS;
+    }
+    
+    uint16_t payload = acfs_cluster_payload(acfs);
+    acfs_error_t ret;
+    if (acfs->header.flags & ACFS_FLAG_CACHE) {
+        ret = acfs_cache_make_room(acfs, data_id, payload);
+        if (ret != ACFS_OK) {
+            return ret;
+        }
+    }
+    
+    acfs_data_entry_t* entry;
+    ret = acfs_prepare_entry(acfs, data_id, payload, &entry);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    entry->type = ACFS_TYPE_COUNTER;
+    entry->data_size = payload;
+    entry->crc32 = 0;
+    acfs->header.sequence++;
+    entry->mod_seq = acfs->header.sequence;
+    entry->expire_at = 0;
+    
+    // 整簇一次写入：第二个基值槽和日志区保持擦除状态
+    acfs_counter_base_t base;
+    base.magic = ACFS_COUNTER_MAGIC;
+    base.generation = 1;
+    base.value = initial;
+    base.crc32 = acfs_crc32(&base, sizeof(base) - sizeof(uint32_t));
+    memset(acfs->cluster_buffer, 0xFF, payload);
+    memcpy(acfs->cluster_buffer + (base.generation % 2) * ACFS_COUNTER_BASE_SLOT, &base, sizeof(base));
+    uint32_t addr = acfs->storage->start_addr + entry->cluster_list[0] * acfs->header.cluster_size;
+    if (acfs->storage->ops.write(addr, acfs->cluster_buffer, payload) != 0) {
+        return ACFS_ERROR_IO_ERROR;
+    }
+    
+    ret = acfs_commit_metadata(acfs);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    acfs_log_change(acfs, ACFS_CHANGE_WRITE, entry->data_id, entry->type, entry->data_size, entry->crc32);
+    return ACFS_OK;
+}
+
+acfs_error_t acfs_counter_add(acfs_t* acfs, const char* data_id, uint32_t delta, uint64_t* value)
+{
+    if (!acfs || !data_id) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    acfs_data_entry_t* entry;
+    acfs_error_t ret = acfs_find_typed(acfs, data_id, ACFS_TYPE_COUNTER, true, &entry);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    acfs_counter_base_t base;
+    uint64_t current;
+    uint16_t log_end;
+    ret = acfs_counter_scan(acfs, entry, &base, &current, &log_end);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    if (value) {
+        *value = current + delta;
+    }
+    
+    if (delta == 0) {
+        return ACFS_OK;
+    }
+    
+    uint32_t check[2] = { delta, base.generation };
+    acfs_counter_record_t record;
+    record.delta = delta;
+    record.check = acfs_crc32(check, sizeof(check));
+    
+    // 日志写满，或记录恰好与擦除状态相同时，连同本次增量压缩进基值
+    if (log_end + sizeof(record) > acfs_cluster_payload(acfs) ||
+        (record.delta == 0xFFFFFFFF && record.check == 0xFFFFFFFF)) {
+        return acfs_counter_compact(acfs, entry, &base, current + delta);
+    }
+    
+    uint32_t addr = acfs->storage->start_addr + entry->cluster_list[0] * acfs->header.cluster_size + log_end;
+    if (acfs->storage->ops.write(addr, &record, sizeof(record)) != 0) {
+        return ACFS_ERROR_IO_ERROR;
+    }
+    
+    return ACFS_OK;
+}
+
+acfs_error_t acfs_counter_get(acfs_t* acfs, const char* data_id, uint64_t* value)
+{
+    if (!acfs || !data_id || !value) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    acfs_data_entry_t* entry;
+    acfs_error_t ret = acfs_find_typed(acfs, data_id, ACFS_TYPE_COUNTER, false, &entry);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    acfs_counter_base_t base;
+    uint16_t log_end;
+    return acfs_counter_scan(acfs, entry, &base, value, &log_end);
+}
+
+acfs_error_t acfs_pin(acfs_t* acfs, const char* data_id)
+{
+    if (!acfs || !data_id) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (acfs->value_cache_size == 0) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    acfs_data_entry_t* entry = acfs_find_entry(acfs, data_id);
+    if (!entry || acfs_entry_expired(acfs, entry)) {
+        return ACFS_ERROR_DATA_NOT_FOUND;
+    }
+    
+    if (entry->type != ACFS_TYPE_VALUE) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    uint16_t slot = (uint16_t)(entry - acfs->entries);
+    acfs_cached_value_t* cached = acfs->value_cache ? acfs->value_cache[slot] : NULL;
+    if (cached && cached->mod_seq == entry->mod_seq) {
+        cached->pinned = true;
+        return ACFS_OK;
+    }
+    
+    cached = acfs_value_cache_alloc(acfs, slot, entry->data_size, true);
+    if (!cached) {
+        return ACFS_ERROR_NO_SPACE;
+    }
+    
+    acfs_error_t ret = acfs_read_verified(acfs, entry, cached->data);
+    if (ret != ACFS_OK) {
+        acfs_value_cache_drop(acfs, slot);
+        return ret;
+    }
+    
+    cached->mod_seq = entry->mod_seq;
+    return ACFS_OK;
+}
+
+acfs_error_t acfs_unpin(acfs_t* acfs, const char* data_id)
+{
+    if (!acfs || !data_id) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    acfs_data_entry_t* entry = acfs_find_entry(acfs, data_id);
+    if (!entry) {
+        return ACFS_ERROR_DATA_NOT_FOUND;
+    }
+    
+    uint16_t slot = (uint16_t)(entry - acfs->entries);
+    if (acfs->value_cache && acfs->value_cache[slot]) {
+        acfs->value_cache[slot]->pinned = false;
+    }
+    return ACFS_OK;
+}
+
+/* 预取时一次设备读取最多合并的簇数 */
+#define ACFS_PREFETCH_RUN 16
+
+/* 预取的数据：按首簇地址排序 */
+typedef struct {
+    uint16_t cluster;               // 首簇
+    uint16_t slot;                  // 条目槽位
+} acfs_prefetch_value_t;
+
+/* 预取的簇：按簇号排序后合并读取 */
+typedef struct {
+    uint16_t cluster;               // 簇号
+    uint16_t slot;                  // 所属条目槽位
+    uint16_t index;                 // 在条目中的簇序号
+} acfs_prefetch_cluster_t;
+
+/* 并行校验预取数据的共享参数 */
+typedef struct {
+    acfs_t* acfs;
+    const acfs_prefetch_value_t* values;
+    bool* valid;                    // 各数据的校验结果
+} acfs_prefetch_job_t;
+
+static int acfs_prefetch_value_cmp(const void* a, const void* b)
+{
+    const acfs_prefetch_value_t* x = (const acfs_prefetch_value_t*)a;
+    const acfs_prefetch_value_t* y = (const acfs_prefetch_value_t*)b;
+    
+    if (x->cluster != y->cluster) return x->cluster < y->cluster ? -1 : 1;
+    if (x->slot != y->slot) return x->slot < y->slot ? -1 : 1;
+    return 0;
+}
+
+static int acfs_prefetch_cluster_cmp(const void* a, const void* b)
+{
+    const acfs_prefetch_cluster_t* x = (const acfs_prefetch_cluster_t*)a;
+    const acfs_prefetch_cluster_t* y = (const acfs_prefetch_cluster_t*)b;
+    
+    if (x->cluster != y->cluster) return x->cluster < y->cluster ? -1 : 1;
+    return 0;
+}
+
+static void acfs_prefetch_task(void* arg, uint32_t index, uint16_t worker)
+{
+    acfs_prefetch_job_t* job = (acfs_prefetch_job_t*)arg;
+    uint16_t slot = job->values[index].slot;
+    const acfs_data_entry_t* entry = &job->acfs->entries[slot];
+    
+    (void)worker;
+    job->valid[index] = acfs_crc32(job->acfs->value_cache[slot]->data, entry->data_size) == entry->crc32;
+}
+
+/**
+ * 按簇号顺序读入已分配缓存项的数据，相邻的簇合并为一次设备读取
+ */
+static acfs_error_t acfs_prefetch_load(acfs_t* acfs, const acfs_prefetch_value_t* values, uint16_t count)
+{
+    uint32_t total = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        total += acfs->entries[values[i].slot].cluster_count;
+    }
+    
+    acfs_prefetch_cluster_t* clusters = (acfs_prefetch_cluster_t*)malloc(total * sizeof(acfs_prefetch_cluster_t));
+    uint8_t* buffer = (uint8_t*)malloc((size_t)ACFS_PREFETCH_RUN * acfs->header.cluster_size);
+    if (!clusters || !buffer) {
+        free(clusters);
+        free(buffer);
+        return ACFS_ERROR_NO_SPACE;
+    }
+    
+    uint32_t n = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        const acfs_data_entry_t* entry = &acfs->entries[values[i].slot];
+        for (uint16_t k = 0; k < entry->cluster_count; k++) {
+            clusters[n].cluster = entry->cluster_list[k];
+            clusters[n].slot = values[i].slot;
+            clusters[n].index = k;
+            n++;
+        }
+    }
+    qsort(clusters, n, sizeof(acfs_prefetch_cluster_t), acfs_prefetch_cluster_cmp);
+    
+    uint16_t payload = acfs_cluster_payload(acfs);
+    acfs_error_t ret = ACFS_OK;
+    uint32_t r = 0;
+    while (r < n) {
+        // 取一段簇号连续的簇，共享的簇只读一次
+        uint16_t first = clusters[r].cluster;
+        uint32_t end = r + 1;
+        while (end < n && clusters[end].cluster - first < ACFS_PREFETCH_RUN &&
+               clusters[end].cluster <= clusters[end - 1].cluster + 1) {
+            end++;
+        }
+        
+        uint16_t span = clusters[end - 1].cluster - first + 1;
+        uint32_t addr = acfs->storage->start_addr + first * acfs->header.cluster_size;
+        if (acfs->storage->ops.read(addr, buffer, (size_t)span * acfs->header.cluster_size) != 0) {
+            ret = ACFS_ERROR_IO_ERROR;
+            break;
+        }
+        
+        for (; r < end; r++) {
+            const acfs_data_entry_t* entry = &acfs->entries[clusters[r].slot];
+            size_t offset = (size_t)clusters[r].index * payload;
+            if (offset >= entry->data_size) {
+                continue;
+            }
+            size_t chunk = entry->data_size - offset < payload ? entry->data_size - offset : payload;
+            memcpy(acfs->value_cache[clusters[r].slot]->data + offset,
+                   buffer + (size_t)(clusters[r].cluster - first) * acfs->header.cluster_size, chunk);
+        }
+    }
+    
+    free(buffer);
+    free(clusters);
+    return ret;
+}
+
+acfs_error_t acfs_prefetch(acfs_t* acfs, const char* const* data_ids, uint16_t count, uint16_t* loaded)
+{
+    if (!acfs || !data_ids) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (acfs->value_cache_size == 0) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (loaded) {
+        *loaded = 0;
+    }
+    if (count == 0) {
+        return ACFS_OK;
+    }
+    
+    acfs_prefetch_value_t* values = (acfs_prefetch_value_t*)malloc(count * sizeof(acfs_prefetch_value_t));
+    bool* valid = (bool*)malloc(count * sizeof(bool));
+    if (!values || !valid) {
+        free(values);
+        free(valid);
+        return ACFS_ERROR_NO_SPACE;
+    }
+    
+    // 找出尚未缓存的数据，不存在的标识直接忽略
+    uint16_t wanted = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        acfs_data_entry_t* entry = data_ids[i] ? acfs_find_entry(acfs, data_ids[i]) : NULL;
+        if (!entry || !entry->is_valid || acfs_entry_expired(acfs, entry) || entry->type != ACFS_TYPE_VALUE ||
+            entry->data_size == 0 || entry->data_size > acfs->value_cache_size) {
+            continue;
+        }
+        
+        uint16_t slot = (uint16_t)(entry - acfs->entries);
+        acfs_cached_value_t* cached = acfs->value_cache ? acfs->value_cache[slot] : NULL;
+        if (cached && cached->mod_seq == entry->mod_seq) {
+            continue;
+        }
+        
+        values[wanted].cluster = entry->cluster_list[0];
+        values[wanted].slot = slot;
+        wanted++;
+    }
+    qsort(values, wanted, sizeof(acfs_prefetch_value_t), acfs_prefetch_value_cmp);
+    
+    // 按地址顺序分配缓存项；容量不足时后分配的会换出先分配的，只保留仍在缓存中的
+    uint16_t taken = 0;
+    for (uint16_t i = 0; i < wanted; i++) {
+        if (taken > 0 && values[taken - 1].slot == values[i].slot) {
+            continue;
+        }
+        uint16_t slot = values[i].slot;
+        acfs_cached_value_t* cached = acfs->value_cache ? acfs->value_cache[slot] : NULL;
+        bool pinned = cached && cached->pinned;
+        if (acfs_value_cache_alloc(acfs, slot, acfs->entries[slot].data_size, pinned)) {
+            values[taken++] = values[i];
+        }
+    }
+    
+    uint16_t kept = 0;
+    for (uint16_t i = 0; i < taken; i++) {
+        if (acfs->value_cache[values[i].slot]) {
+            values[kept++] = values[i];
+        }
+    }
+    
+    // 全部已缓存、不存在或放不进缓存时无需读取
+    if (kept == 0) {
+        free(values);
+        free(valid);
+        return ACFS_OK;
+    }
+    
+    acfs_error_t ret = acfs_prefetch_load(acfs, values, kept);
+    if (ret != ACFS_OK) {
+        for (uint16_t i = 0; i < kept; i++) {
+            acfs_value_cache_drop(acfs, values[i].slot);
+        }
+        free(values);
+        free(valid);
+        return ret;
+    }
+    
+    // 校验CRC，未通过的不留在缓存中，读取时再报告错误
+    acfs_prefetch_job_t job;
+    job.acfs = acfs;
+    job.values = values;
+    job.valid = valid;
+    acfs_parallel_for(acfs, acfs_prefetch_task, &job, kept);
+    
+    uint16_t hits = 0;
+    for (uint16_t i = 0; i < kept; i++) {
+        uint16_t slot = values[i].slot;
+        if (valid[i]) {
+            acfs->value_cache[slot]->mod_seq = acfs->entries[slot].mod_seq;
+            hits++;
+        } else {
+            acfs_value_cache_drop(acfs, slot);
+        }
+    }
+    
+    if (loaded) {
+        *loaded = hits;
+    }
+    
+    free(values);
+    free(valid);
+    return ACFS_OK;
+}
+
+acfs_error_t acfs_expire(acfs_t* acfs, uint16_t max_batch, uint16_t* reclaimed)
+{
+    if (!acfs) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    uint16_t count = 0;
+    if (reclaimed) {
+        *reclaimed = 0;
+    }
+    
+    // 没有时间源时不会有数据过期
+    if (!acfs->get_time) {
+        return ACFS_OK;
+    }
+    
+    if (acfs->expiry_dirty) {
+        acfs_error_t ret = acfs_expiry_rebuild(acfs);
+        if (ret != ACFS_OK) {
+            return ret;
+        }
+    }
+    
+    uint32_t now = acfs->get_time();
+    acfs_error_t ret = ACFS_OK;
+    
+    while (acfs->expiry_count > 0 && acfs->expiry_heap[0].expire_at <= now &&
+           (max_batch == 0 || count < max_batch)) {
+        acfs_expiry_t top = acfs->expiry_heap[0];
+        
+        // 取出堆顶，末项下沉
+        acfs->expiry_heap[0] = acfs->expiry_heap[--acfs->expiry_count];
+        uint16_t i = 0;
+        while (true) {
+            uint16_t smallest = i;
+            uint16_t left = 2 * i + 1;
+            uint16_t right = 2 * i + 2;
+            if (left < acfs->expiry_count && acfs->expiry_heap[left].expire_at < acfs->expiry_heap[smallest].expire_at) {
+                smallest = left;
+            }
+            if (right < acfs->expiry_count && acfs->expiry_heap[right].expire_at < acfs->expiry_heap[smallest].expire_at) {
+                smallest = right;
+            }
+            if (smallest == i) {
+                break;
+            }
+            acfs_expiry_t tmp = acfs->expiry_heap[i];
+            acfs->expiry_heap[i] = acfs->expiry_heap[smallest];
+            acfs->expiry_heap[smallest] = tmp;
+            i = smallest;
+        }
+        
+        // 条目被重写或删除后索引项失效，直接丢弃
+        if (top.slot >= acfs->header.data_entries) {
+            continue;
+        }
+        acfs_data_entry_t* entry = &acfs->entries[top.slot];
+        if (!entry->is_valid || entry->expire_at != top.expire_at) {
+            continue;
+        }
+        
+        acfs->header.sequence++;
+        ret = acfs_remove_entry(acfs, entry);
+        if (ret != ACFS_OK) {
+            break;
+        }
+        acfs_log_change(acfs, ACFS_CHANGE_DELETE, entry->data_id, entry->type, 0, 0);
+        count++;
+    }
+    
+    // 整批只提交一次元数据
+    if (count > 0) {
+        acfs_error_t commit_ret = acfs_commit_metadata(acfs);
+        if (ret == ACFS_OK) {
+            ret = commit_ret;
+        }
+    }
+    
+    if (reclaimed) {
+        *reclaimed = count;
+    }
+    return ret;
+}
+
+acfs_error_t acfs_reserve(acfs_t* acfs, const char* data_id, size_t expected_size)
+{
+    if (!acfs || !data_id || expected_size == 0) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (strlen(data_id) >= ACFS_MAX_DATA_ID_LEN) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    // 重复预留时先归还原有的预留
+    acfs_reservation_t* reservation = acfs_find_reservation(acfs, data_id);
+    if (reservation) {
+        acfs_release_reservation(acfs, data_id);
+    }
+    
+    // 已有数据只需预留超出现有簇数的部分
+    uint16_t count = acfs_calculate_clusters_needed(acfs_cluster_payload(acfs), expected_size);
+    acfs_data_entry_t* entry = acfs_find_entry(acfs, data_id);
+    if (entry && !acfs_entry_expired(acfs, entry)) {
+        if (entry->cluster_count >= count) {
+            return ACFS_OK;
+        }
+        count -= entry->cluster_count;
+    }
+    
+    reservation = NULL;
+    for (uint16_t i = 0; i < ACFS_RESERVATIONS; i++) {
+        if (acfs->reservations[i].data_id[0] == '\0') {
+            reservation = &acfs->reservations[i];
+            break;
+        }
+    }
+    if (!reservation) {
+        return ACFS_ERROR_BUSY;
+    }
+    
+    // 由分配策略取一段足够长的连续空闲簇
+    uint16_t start = 0;
+    if (acfs->allocator->allocate(acfs, count, true, ACFS_HINT_NONE, &start) != count &&
+        (acfs_magazine_flush(acfs) == 0 ||
+         acfs->allocator->allocate(acfs, count, true, ACFS_HINT_NONE, &start) != count)) {
+        return ACFS_ERROR_NO_SPACE;
+    }
+    
+    for (uint16_t i = start; i < start + count; i++) {
+        acfs->cluster_bitmap[i / 8] |= (1 << (i % 8));
+    }
+    acfs->header.free_clusters -= count;
+    
+    strncpy(reservation->data_id, data_id, ACFS_MAX_DATA_ID_LEN - 1);
+    reservation->data_id[ACFS_MAX_DATA_ID_LEN - 1] = '\0';
+    reservation->next = start;
+    reservation->remaining = count;
+    return ACFS_OK;
+}
+
+acfs_error_t acfs_release_reservation(acfs_t* acfs, const char* data_id)
+{
+    if (!acfs || !data_id) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    acfs_reservation_t* reservation = acfs_find_reservation(acfs, data_id);
+    if (!reservation) {
+        return ACFS_ERROR_DATA_NOT_FOUND;
+    }
+    
+    for (uint16_t i = reservation->next; i < reservation->next + reservation->remaining; i++) {
+        acfs->cluster_bitmap[i / 8] &= ~(1 << (i % 8));
+    }
+    acfs->allocator->release(acfs, reservation->next, reservation->remaining);
+    acfs->header.free_clusters += reservation->remaining;
+    
+    reservation->data_id[0] = '\0';
+    reservation->remaining = 0;
+    return ACFS_OK;
+}
+
+acfs_error_t acfs_defragment(acfs_t* acfs)
+{
+    // 压缩式碎片整理：把最高地址的已用簇搬到最低地址的空闲簇，
+    // 通过反向映射直接定位并修改所属条目，搬移代价与搬移数据量成正比
+    if (!acfs || !acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (acfs->freeze_count > 0) {
+        return ACFS_ERROR_BUSY;
+    }
+    
+    // 单簇分配缓存中的簇先归还，使其参与压缩
+    acfs_magazine_flush(acfs);
+    
+    uint16_t low = acfs->header.sys_clusters;
+    uint16_t high = acfs->header.total_clusters - 1;
+    uint16_t moved = 0;
+    
+    while (low < high) {
+        // 找最低的空闲簇
+        if (acfs->cluster_bitmap[low / 8] & (1 << (low % 8))) {
+            low++;
+            continue;
+        }
+        
+        // 找最高的已用簇
+        if (!(acfs->cluster_bitmap[high / 8] & (1 << (high % 8)))) {
+            high--;
+            continue;
+        }
+        
+        // 只被快照引用或被共享的簇不搬移
+        acfs_cluster_owner_t owner = acfs->cluster_owner[high];
+        if (owner.slot == ACFS_OWNER_NONE || acfs->cluster_refs[high] > 1) {
+            high--;
+            continue;
+        }
+        
+        // 搬移簇数据
+        uint32_t src_addr = acfs->storage->start_addr + (uint32_t)high * acfs->header.cluster_size;
+        uint32_t dst_addr = acfs->storage->start_addr + (uint32_t)low * acfs->header.cluster_size;
+        if (acfs->storage->ops.read(src_addr, acfs->cluster_buffer, acfs->header.cluster_size) != 0 ||
+            acfs->storage->ops.write(dst_addr, acfs->cluster_buffer, acfs->header.cluster_size) != 0) {
+            if (moved > 0) {
+                acfs->allocator->mount(acfs);
+                acfs_commit_metadata(acfs);
+            }
+            return ACFS_ERROR_IO_ERROR;
+        }
+        
+        // 更新所属条目、位图和反向映射
+        acfs->entries[owner.slot].cluster_list[owner.index] = low;
+        acfs->cluster_bitmap[low / 8] |= (1 << (low % 8));
+        acfs->cluster_bitmap[high / 8] &= ~(1 << (high % 8));
+        acfs->cluster_owner[low] = owner;
+        acfs->cluster_owner[high].slot = ACFS_OWNER_NONE;
+        acfs->cluster_owner[high].index = ACFS_OWNER_NONE;
+        acfs->cluster_refs[low] = 1;
+        acfs->cluster_refs[high] = 0;
+        
+        moved++;
+        low++;
+        high--;
+    }
+    
+    if (moved == 0) {
+        return ACFS_OK;
+    }
+    
+    // 空闲簇分布整体改变，由分配策略按位图重建
+    acfs_error_t ret = acfs->allocator->mount(acfs);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    return acfs_commit_metadata(acfs);
+}
+
+acfs_error_t acfs_get_cluster_owner(acfs_t* acfs, uint16_t cluster, uint16_t* slot, uint16_t* index)
+{
+    if (!acfs) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!acfs->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    if (cluster >= acfs->header.total_clusters) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    acfs_cluster_owner_t owner = acfs->cluster_owner[cluster];
+    if (owner.slot == ACFS_OWNER_NONE) {
+        return ACFS_ERROR_DATA_NOT_FOUND;
+    }
+    
+    if (slot) {
+        *slot = owner.slot;
+    }
+    
+    if (index) {
+        *index = owner.index;
+    }
+    
+    return ACFS_OK;
+} 
+/* 元数据重建 */
+
+typedef struct {
+    uint32_t owner_hash;
+    uint32_t sequence;
+    uint16_t index;
+    uint16_t cluster;
+} acfs_fsck_cluster_t;
+
+typedef struct {
+    uint32_t owner_hash;
+    uint32_t sequence;
+    uint32_t data_size;
+    uint32_t data_crc;
+    uint16_t cluster_count;
+    bool deleted;
+} acfs_fsck_value_t;
+
+/**
+ * 按所属标识、簇序号升序，序列号降序排列
+ */
+static int acfs_fsck_cluster_cmp(const void* a, const void* b)
+{
+    const acfs_fsck_cluster_t* x = (const acfs_fsck_cluster_t*)a;
+    const acfs_fsck_cluster_t* y = (const acfs_fsck_cluster_t*)b;
+    
+    if (x->owner_hash != y->owner_hash) return x->owner_hash < y->owner_hash ? -1 : 1;
+    if (x->index != y->index) return x->index < y->index ? -1 : 1;
+    if (x->sequence != y->sequence) return x->sequence > y->sequence ? -1 : 1;
+    return 0;
+}
+
+/**
+ * 按所属标识升序、序列号降序排列
+ */
+static int acfs_fsck_value_cmp(const void* a, const void* b)
+{
+    const acfs_fsck_value_t* x = (const acfs_fsck_value_t*)a;
+    const acfs_fsck_value_t* y = (const acfs_fsck_value_t*)b;
+    
+    if (x->owner_hash != y->owner_hash) return x->owner_hash < y->owner_hash ? -1 : 1;
+    if (x->sequence != y->sequence) return x->sequence > y->sequence ? -1 : 1;
+    return 0;
+}
+
+/**
+ * 为恢复的条目找回名称：优先使用旧条目表中同一所属标识的名称
+ */
+static void acfs_fsck_name_entry(acfs_t* acfs, const acfs_data_entry_t* old_entries, uint16_t old_count,
+                                 acfs_data_entry_t* entry, acfs_fsck_report_t* report)
+{
+    for (uint16_t i = 0; i < old_count; i++) {
+        const acfs_data_entry_t* old = &old_entries[i];
+        // 删除标记可能带有改名前条目的所属标识，不参与匹配
+        if (!old->is_valid || old->owner_hash != entry->owner_hash || old->data_id[0] == '\0' ||
+            !memchr(old->data_id, '\0', ACFS_MAX_DATA_ID_LEN)) {
+            continue;
+        }
+        
+        if (!acfs_find_entry(acfs, old->data_id)) {
+            memcpy(entry->data_id, old->data_id, ACFS_MAX_DATA_ID_LEN);
+            return;
+        }
+    }
+    
+    snprintf(entry->data_id, ACFS_MAX_DATA_ID_LEN, "lost.%08lx", (unsigned long)entry->owner_hash);
+    report->entries_unnamed++;
+}
+
+acfs_error_t acfs_fsck(storage_device_t* storage, const acfs_config_t* config, acfs_fsck_report_t* report)
+{
+    if (!storage || !config) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    acfs_fsck_report_t local_report;
+    if (!report) {
+        report = &local_report;
+    }
+    memset(report, 0, sizeof(acfs_fsck_report_t));
+    
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs_t));
+    acfs.storage = storage;
+    
+    // 头部完好时沿用其布局，否则按配置推断；其他格式版本的卷不按本版本的布局重建
+    acfs_error_t header_ret = acfs_load_header(&acfs);
+    if (header_ret == ACFS_ERROR_INVALID_FILESYSTEM && acfs.header.magic == ACFS_MAGIC_NUMBER) {
+        return ACFS_ERROR_INVALID_FILESYSTEM;
+    }
+    bool header_ok = (header_ret == ACFS_OK);
+    if (header_ok) {
+        if (!(acfs.header.flags & ACFS_FLAG_CLUSTER_TRAILER)) {
+            return ACFS_ERROR_INVALID_FILESYSTEM;
+        }
+    } else {
+        if (!config->enable_cluster_trailer ||
+            config->cluster_size < ACFS_CLUSTER_SIZE_MIN ||
+            config->cluster_size > ACFS_CLUSTER_SIZE_MAX ||
+            (config->cluster_size & (config->cluster_size - 1)) != 0) {
+            return ACFS_ERROR_INVALID_FILESYSTEM;
+        }
+        
+        uint16_t sys_clusters = config->reserved_clusters;
+        if (sys_clusters == 0) {
+            sys_clusters = (sizeof(acfs_header_t) + config->cluster_size - 1) / config->cluster_size;
+            if (sys_clusters < 2) sys_clusters = 2;
+        }
+        
+        memset(&acfs.header, 0, sizeof(acfs_header_t));
+        acfs.header.magic = ACFS_MAGIC_NUMBER;
+        acfs.header.version = (ACFS_VERSION_MAJOR << 8) | ACFS_VERSION_MINOR;
+        acfs.header.cluster_size = config->cluster_size;
+        acfs.header.total_clusters = storage->size / config->cluster_size;
+        acfs.header.sys_clusters = sys_clusters;
+        acfs.header.flags = ACFS_FLAG_CLUSTER_TRAILER;
+        if (config->cache_mode) {
+            acfs.header.flags |= ACFS_FLAG_CACHE;
+        }
+        
+        if (sys_clusters >= acfs.header.total_clusters) {
+            return ACFS_ERROR_INVALID_PARAM;
+        }
+    }
+    
+    uint16_t cluster_size = acfs.header.cluster_size;
+    uint16_t total_clusters = acfs.header.total_clusters;
+    uint16_t payload = acfs_cluster_payload(&acfs);
+    uint16_t max_entries = (acfs.header.sys_clusters * cluster_size - sizeof(acfs_header_t)) / sizeof(acfs_data_entry_t);
+    uint16_t old_data_entries = acfs.header.data_entries;
+    acfs.header.data_entries = 0;
+    // 快照无法从簇尾部重建
+    acfs.header.snapshot_entries = 0;
+    acfs.header.flags &= ~ACFS_FLAG_SNAPSHOT;
+    
+    acfs.entries = (acfs_data_entry_t*)calloc(max_entries, sizeof(acfs_data_entry_t));
+    acfs.cluster_buffer = (uint8_t*)malloc(cluster_size);
+    acfs_fsck_cluster_t* clusters = (acfs_fsck_cluster_t*)malloc(total_clusters * sizeof(acfs_fsck_cluster_t));
+    acfs_fsck_value_t* values = (acfs_fsck_value_t*)malloc(total_clusters * sizeof(acfs_fsck_value_t));
+    acfs_data_entry_t* old_entries = NULL;
+    uint16_t old_count = 0;
+    acfs_error_t ret = ACFS_OK;
+    
+    if (!acfs.entries || !acfs.cluster_buffer || !clusters || !values) {
+        ret = ACFS_ERROR_NO_SPACE;
+        goto cleanup;
+    }
+    
+    // 尽力读取旧条目表，仅用于找回名称
+    if (header_ok && old_data_entries > 0 && old_data_entries <= max_entries) {
+        old_entries = (acfs_data_entry_t*)malloc(old_data_entries * sizeof(acfs_data_entry_t));
+        if (old_entries &&
+            storage->ops.read(storage->start_addr + sizeof(acfs_header_t), old_entries,
+                              old_data_entries * sizeof(acfs_data_entry_t)) == 0) {
+            old_count = old_data_entries;
+        }
+    }
+    
+    // 一次顺序扫描：校验每个簇的尾部，记录簇归属和每个数据的末簇信息
+    uint32_t max_sequence = header_ok ? acfs.header.sequence : 0;
+    uint16_t cluster_records = 0;
+    uint16_t value_records = 0;
+    
+    for (uint16_t c = acfs.header.sys_clusters; c < total_clusters; c++) {
+        uint32_t addr = storage->start_addr + (uint32_t)c * cluster_size;
+        report->clusters_scanned++;
+        if (storage->ops.read(addr, acfs.cluster_buffer, cluster_size) != 0) {
+            ret = ACFS_ERROR_IO_ERROR;
+            goto cleanup;
+        }
+        
+        acfs_cluster_trailer_t trailer;
+        memcpy(&trailer, acfs.cluster_buffer + payload, sizeof(trailer));
+        
+        uint32_t crc;
+        if (trailer.magic == ACFS_TRAILER_MAGIC) {
+            crc = acfs_crc32_update(acfs_crc32_init(), acfs.cluster_buffer, payload);
+            crc = acfs_crc32_finalize(acfs_crc32_update(crc, &trailer, sizeof(trailer) - sizeof(uint32_t)));
+        } else if (trailer.magic == ACFS_TRAILER_MAGIC_DELETED) {
+            crc = acfs_crc32(&trailer, sizeof(trailer) - sizeof(uint32_t));
+        } else {
+            continue;
+        }
+        
+        if (crc != trailer.crc32) {
+            continue;
+        }
+        
+        report->clusters_valid++;
+        if (trailer.sequence > max_sequence) {
+            max_sequence = trailer.sequence;
+        }
+        
+        if (trailer.magic == ACFS_TRAILER_MAGIC) {
+            acfs_fsck_cluster_t* record = &clusters[cluster_records++];
+            record->owner_hash = trailer.owner_hash;
+            record->sequence = trailer.sequence;
+            record->index = trailer.index;
+            record->cluster = c;
+        }
+        
+        if (trailer.magic == ACFS_TRAILER_MAGIC_DELETED || trailer.data_size != 0) {
+            acfs_fsck_value_t* value = &values[value_records++];
+            value->owner_hash = trailer.owner_hash;
+            value->sequence = trailer.sequence;
+            value->data_size = trailer.data_size;
+            value->data_crc = trailer.data_crc;
+            value->cluster_count = trailer.index + 1;
+            value->deleted = (trailer.magic == ACFS_TRAILER_MAGIC_DELETED);
+        }
+    }
+    
+    qsort(clusters, cluster_records, sizeof(acfs_fsck_cluster_t), acfs_fsck_cluster_cmp);
+    
+    // 每个所属标识只保留序列号最大的末簇或删除标记
+    qsort(values, value_records, sizeof(acfs_fsck_value_t), acfs_fsck_value_cmp);
+    uint16_t latest = 0;
+    for (uint16_t i = 0; i < value_records; i++) {
+        if (latest == 0 || values[latest - 1].owner_hash != values[i].owner_hash) {
+            values[latest++] = values[i];
+        }
+    }
+    value_records = latest;
+    
+    // 组装条目：每个序号取不晚于末簇序列号的最新簇
+    uint16_t used_clusters = 0;
+    for (uint16_t v = 0; v < value_records; v++) {
+        acfs_fsck_value_t* value = &values[v];
+        if (value->deleted) {
+            continue;
+        }
+        
+        if (acfs.header.data_entries >= max_entries) {
+            report->entries_dropped++;
+            continue;
+        }
+        
+        uint16_t* cluster_list = (uint16_t*)malloc(value->cluster_count * sizeof(uint16_t));
+        if (!cluster_list) {
+            ret = ACFS_ERROR_NO_SPACE;
+            goto cleanup;
+        }
+        memset(cluster_list, 0xFF, value->cluster_count * sizeof(uint16_t));
+        
+        // 二分查找该所属标识的第一条记录
+        uint16_t lo = 0, hi = cluster_records;
+        while (lo < hi) {
+            uint16_t mid = lo + (hi - lo) / 2;
+            if (clusters[mid].owner_hash < value->owner_hash) lo = mid + 1;
+            else hi = mid;
+        }
+        
+        uint16_t found = 0;
+        for (uint16_t i = lo; i < cluster_records && clusters[i].owner_hash == value->owner_hash; i++) {
+            acfs_fsck_cluster_t* record = &clusters[i];
+            if (record->index < value->cluster_count && record->sequence <= value->sequence &&
+                cluster_list[record->index] == ACFS_OWNER_NONE) {
+                cluster_list[record->index] = record->cluster;
+                found++;
+            }
+        }
+        
+        if (found != value->cluster_count) {
+            free(cluster_list);
+            report->entries_dropped++;
+            continue;
+        }
+        
+        // 用末簇记录的数据CRC校验组装结果，混入旧版本簇或不完整的条目被丢弃
+        uint32_t crc = acfs_crc32_init();
+        for (uint16_t i = 0; i < value->cluster_count && (size_t)i * payload < value->data_size; i++) {
+            size_t offset = (size_t)i * payload;
+            size_t chunk = value->data_size - offset < payload ? value->data_size - offset : payload;
+            if (storage->ops.read(storage->start_addr + (uint32_t)cluster_list[i] * cluster_size,
+                                  acfs.cluster_buffer, chunk) != 0) {
+                free(cluster_list);
+                ret = ACFS_ERROR_IO_ERROR;
+                goto cleanup;
+            }
+            crc = acfs_crc32_update(crc, acfs.cluster_buffer, chunk);
+        }
+        if (acfs_crc32_finalize(crc) != value->data_crc) {
+            free(cluster_list);
+            report->entries_dropped++;
+            continue;
+        }
+        
+        acfs_data_entry_t* entry = &acfs.entries[acfs.header.data_entries];
+        entry->owner_hash = value->owner_hash;
+        entry->data_size = value->data_size;
+        entry->crc32 = value->data_crc;
+        entry->cluster_count = value->cluster_count;
+        entry->cluster_list = cluster_list;
+        entry->mod_seq = value->sequence;
+        acfs_fsck_name_entry(&acfs, old_entries, old_count, entry, report);
+        entry->is_valid = true;
+        
+        acfs.header.data_entries++;
+        used_clusters += value->cluster_count;
+        report->entries_recovered++;
+    }
+    
+    // 写回重建的头部和条目表，位图在挂载时由条目表重建
+    acfs.header.free_clusters = total_clusters - acfs.header.sys_clusters - used_clusters;
+    acfs.header.sequence = max_sequence + 1;
+    // 删除标记无法从簇尾部重建，此前的增量导出起点全部失效
+    acfs.header.tombstone_floor = acfs.header.sequence;
+    ret = acfs_commit_metadata(&acfs);
+    
+cleanup:
+    if (acfs.entries) {
+        for (uint16_t i = 0; i < acfs.header.data_entries; i++) {
+            free(acfs.entries[i].cluster_list);
+        }
+        free(acfs.entries);
+    }
+    free(acfs.cluster_buffer);
+    free(clusters);
+    free(values);
+    free(old_entries);
+    return ret;
+}
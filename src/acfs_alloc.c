@@ -0,0 +1,349 @@
+#include "../include/acfs.h"
+#include <string.h>
+#include <stdlib.h>
+
+/* 簇分配策略：核心负责位图和簇列表，策略只决定使用哪些空闲簇 */
+
+/* 按位置提示查找空闲簇时最多扫描的簇数 */
+#define ACFS_HINT_WINDOW 512
+
+static bool acfs_cluster_free(const acfs_t* acfs, uint16_t cluster)
+{
+    return !(acfs->cluster_bitmap[cluster / 8] & (1 << (cluster % 8)));
+}
+
+/* ---------- 首个空闲簇策略 ---------- */
+
+/**
+ * 从first开始取第一段空闲簇；contiguous为true时跳过不足count的段
+ */
+static uint16_t acfs_first_fit_scan(acfs_t* acfs, uint16_t first, uint16_t count, bool contiguous, uint16_t* start)
+{
+    uint16_t run = 0;
+    for (uint32_t i = first; i < acfs->header.total_clusters; i++) {
+        if (!acfs_cluster_free(acfs, (uint16_t)i)) {
+            if (run > 0 && !contiguous) {
+                break;
+            }
+            run = 0;
+            continue;
+        }
+        if (run == 0) {
+            *start = (uint16_t)i;
+        }
+        if (++run == count) {
+            break;
+        }
+    }
+
+    if (contiguous && run < count) {
+        return 0;
+    }
+    return run;
+}
+
+/**
+ * 从位置提示处开始查找，其后没有空闲簇时从低地址开始
+ */
+static uint16_t acfs_first_fit_allocate(acfs_t* acfs, uint16_t count, bool contiguous, uint16_t hint, uint16_t* start)
+{
+    if (hint > acfs->header.sys_clusters && hint < acfs->header.total_clusters) {
+        uint16_t run = acfs_first_fit_scan(acfs, hint, count, contiguous, start);
+        if (run > 0) {
+            return run;
+        }
+    }
+    return acfs_first_fit_scan(acfs, acfs->header.sys_clusters, count, contiguous, start);
+}
+
+static void acfs_first_fit_stats(const acfs_t* acfs, acfs_alloc_stats_t* stats)
+{
+    uint16_t run = 0;
+    for (uint32_t i = acfs->header.sys_clusters; i <= acfs->header.total_clusters; i++) {
+        if (i < acfs->header.total_clusters && acfs_cluster_free(acfs, (uint16_t)i)) {
+            run++;
+            continue;
+        }
+        if (run > 0) {
+            stats->free_clusters += run;
+            stats->free_extents++;
+            if (run > stats->largest_extent) {
+                stats->largest_extent = run;
+            }
+            run = 0;
+        }
+    }
+}
+
+static acfs_error_t acfs_first_fit_mount(acfs_t* acfs)
+{
+    (void)acfs;
+    return ACFS_OK;
+}
+
+static void acfs_first_fit_unmount(acfs_t* acfs)
+{
+    (void)acfs;
+}
+
+static void acfs_first_fit_release(acfs_t* acfs, uint16_t start, uint16_t length)
+{
+    (void)acfs;
+    (void)start;
+    (void)length;
+}
+
+const acfs_allocator_t acfs_allocator_first_fit = {
+    .name = "first-fit",
+    .mount = acfs_first_fit_mount,
+    .unmount = acfs_first_fit_unmount,
+    .allocate = acfs_first_fit_allocate,
+    .release = acfs_first_fit_release,
+    .stats = acfs_first_fit_stats
+};
+
+/* ---------- 连续段策略 ---------- */
+
+static uint8_t acfs_extent_class(uint16_t length)
+{
+    uint8_t cls = 0;
+    while (length >>= 1) {
+        cls++;
+    }
+    return cls;
+}
+
+static void acfs_extent_link(acfs_extent_index_t* index, uint16_t start, uint16_t length)
+{
+    acfs_extent_node_t* nodes = index->nodes;
+    uint8_t cls = acfs_extent_class(length);
+
+    nodes[start].length = length;
+    nodes[start].prev = ACFS_EXTENT_NONE;
+    nodes[start].next = index->head[cls];
+    if (nodes[start].next != ACFS_EXTENT_NONE) {
+        nodes[nodes[start].next].prev = start;
+    }
+    index->head[cls] = start;
+    nodes[start + length - 1].start = start;
+}
+
+static void acfs_extent_unlink(acfs_extent_index_t* index, uint16_t start)
+{
+    acfs_extent_node_t* node = &index->nodes[start];
+
+    if (node->prev != ACFS_EXTENT_NONE) {
+        index->nodes[node->prev].next = node->next;
+    } else {
+        index->head[acfs_extent_class(node->length)] = node->next;
+    }
+    if (node->next != ACFS_EXTENT_NONE) {
+        index->nodes[node->next].prev = node->prev;
+    }
+    node->length = 0;
+}
+
+/**
+ * 按位图建立空闲段索引；从高地址向低地址建立，各级别链表按地址升序
+ */
+static acfs_error_t acfs_extent_mount(acfs_t* acfs)
+{
+    acfs_extent_index_t* index = (acfs_extent_index_t*)acfs->allocator_state;
+    if (!index) {
+        index = (acfs_extent_index_t*)malloc(sizeof(acfs_extent_index_t) +
+                                             acfs->header.total_clusters * sizeof(acfs_extent_node_t));
+        if (!index) {
+            return ACFS_ERROR_NO_SPACE;
+        }
+        acfs->allocator_state = index;
+    }
+
+    for (uint8_t c = 0; c < ACFS_EXTENT_CLASSES; c++) {
+        index->head[c] = ACFS_EXTENT_NONE;
+    }
+    memset(index->nodes, 0, acfs->header.total_clusters * sizeof(acfs_extent_node_t));
+
+    uint16_t run = 0;
+    for (uint16_t i = acfs->header.total_clusters; i > acfs->header.sys_clusters; i--) {
+        uint16_t cluster = i - 1;
+        if (acfs_cluster_free(acfs, cluster)) {
+            run++;
+            continue;
+        }
+        if (run > 0) {
+            acfs_extent_link(index, cluster + 1, run);
+            run = 0;
+        }
+    }
+    if (run > 0) {
+        acfs_extent_link(index, acfs->header.sys_clusters, run);
+    }
+
+    return ACFS_OK;
+}
+
+static void acfs_extent_unmount(acfs_t* acfs)
+{
+    free(acfs->allocator_state);
+    acfs->allocator_state = NULL;
+}
+
+/**
+ * 查找至少count簇长的空闲段，没有时返回最长的段（均无空闲时返回ACFS_EXTENT_NONE）
+ * 高一级别的任一段都够长，只需检查各级别链表头；只有本级别需要逐段比较。
+ */
+static uint16_t acfs_extent_find(const acfs_extent_index_t* index, uint16_t count)
+{
+    uint8_t cls = acfs_extent_class(count);
+    uint8_t first = ((count & (count - 1)) == 0) ? cls : cls + 1;
+    for (uint8_t c = first; c < ACFS_EXTENT_CLASSES; c++) {
+        if (index->head[c] != ACFS_EXTENT_NONE) {
+            return index->head[c];
+        }
+    }
+
+    uint16_t longest = ACFS_EXTENT_NONE;
+    for (uint16_t s = index->head[cls]; s != ACFS_EXTENT_NONE; s = index->nodes[s].next) {
+        if (index->nodes[s].length >= count) {
+            return s;
+        }
+        if (longest == ACFS_EXTENT_NONE || index->nodes[s].length > index->nodes[longest].length) {
+            longest = s;
+        }
+    }
+
+    for (uint8_t c = cls; longest == ACFS_EXTENT_NONE && c > 0; c--) {
+        longest = index->head[c - 1];
+    }
+    return longest;
+}
+
+/**
+ * 在位置提示之后的窗口内取第一个空闲簇开始的一段，所在空闲段的其余部分留在索引中
+ */
+static uint16_t acfs_extent_near(acfs_t* acfs, uint16_t count, bool contiguous, uint16_t hint, uint16_t* start)
+{
+    acfs_extent_index_t* index = (acfs_extent_index_t*)acfs->allocator_state;
+    uint32_t limit = (uint32_t)hint + ACFS_HINT_WINDOW;
+    if (limit > acfs->header.total_clusters) {
+        limit = acfs->header.total_clusters;
+    }
+
+    uint32_t first = hint;
+    while (first < limit && !acfs_cluster_free(acfs, (uint16_t)first)) {
+        first++;
+    }
+    if (first >= limit) {
+        return 0;
+    }
+
+    // 空闲段的段尾记录段首
+    uint32_t end = first;
+    while (end < acfs->header.total_clusters && acfs_cluster_free(acfs, (uint16_t)end)) {
+        end++;
+    }
+    uint16_t extent = index->nodes[end - 1].start;
+    uint16_t extent_end = (uint16_t)end;
+
+    uint16_t length = (end - first) < count ? (uint16_t)(end - first) : count;
+    if (contiguous && length < count) {
+        return 0;
+    }
+
+    acfs_extent_unlink(index, extent);
+    if (first > extent) {
+        acfs_extent_link(index, extent, (uint16_t)(first - extent));
+    }
+    if (first + length < extent_end) {
+        acfs_extent_link(index, (uint16_t)(first + length), (uint16_t)(extent_end - first - length));
+    }
+
+    *start = (uint16_t)first;
+    return length;
+}
+
+/**
+ * 取出一段空闲簇的开头部分，剩余部分留在索引中；有位置提示时先在其后查找
+ */
+static uint16_t acfs_extent_allocate(acfs_t* acfs, uint16_t count, bool contiguous, uint16_t hint, uint16_t* start)
+{
+    acfs_extent_index_t* index = (acfs_extent_index_t*)acfs->allocator_state;
+    if (count == 0) {
+        return 0;
+    }
+
+    if (hint >= acfs->header.sys_clusters && hint < acfs->header.total_clusters) {
+        uint16_t length = acfs_extent_near(acfs, count, contiguous, hint, start);
+        if (length > 0) {
+            return length;
+        }
+    }
+
+    uint16_t found = acfs_extent_find(index, count);
+    if (found == ACFS_EXTENT_NONE) {
+        return 0;
+    }
+
+    uint16_t total = index->nodes[found].length;
+    if (contiguous && total < count) {
+        return 0;
+    }
+
+    uint16_t length = total < count ? total : count;
+    acfs_extent_unlink(index, found);
+    if (total > length) {
+        acfs_extent_link(index, found + length, total - length);
+    }
+
+    *start = found;
+    return length;
+}
+
+/**
+ * 把刚在位图中清除的簇段加入索引，与相邻的空闲段合并
+ */
+static void acfs_extent_release(acfs_t* acfs, uint16_t start, uint16_t length)
+{
+    acfs_extent_index_t* index = (acfs_extent_index_t*)acfs->allocator_state;
+    if (length == 0) {
+        return;
+    }
+
+    uint16_t end = start + length;
+    if (start > acfs->header.sys_clusters && acfs_cluster_free(acfs, start - 1)) {
+        uint16_t left = index->nodes[start - 1].start;
+        acfs_extent_unlink(index, left);
+        length += start - left;
+        start = left;
+    }
+
+    if (end < acfs->header.total_clusters && acfs_cluster_free(acfs, end)) {
+        length += index->nodes[end].length;
+        acfs_extent_unlink(index, end);
+    }
+
+    acfs_extent_link(index, start, length);
+}
+
+static void acfs_extent_stats(const acfs_t* acfs, acfs_alloc_stats_t* stats)
+{
+    const acfs_extent_index_t* index = (const acfs_extent_index_t*)acfs->allocator_state;
+    for (uint8_t c = 0; c < ACFS_EXTENT_CLASSES; c++) {
+        for (uint16_t s = index->head[c]; s != ACFS_EXTENT_NONE; s = index->nodes[s].next) {
+            stats->free_clusters += index->nodes[s].length;
+            stats->free_extents++;
+            if (index->nodes[s].length > stats->largest_extent) {
+                stats->largest_extent = index->nodes[s].length;
+            }
+        }
+    }
+}
+
+const acfs_allocator_t acfs_allocator_extent = {
+    .name = "extent",
+    .mount = acfs_extent_mount,
+    .unmount = acfs_extent_unmount,
+    .allocate = acfs_extent_allocate,
+    .release = acfs_extent_release,
+    .stats = acfs_extent_stats
+};
@@ -0,0 +1,248 @@
+#define _POSIX_C_SOURCE 200809L
+#include "../include/acfs.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+/*
+ * 内置执行器：固定数量的工作线程（含提交任务的线程），工作项按下标区间均分给各线程，
+ * 各线程从自己区间的头部取工作项，做完后从其他线程区间的尾部窃取一半。
+ */
+
+/* 工作线程持有的下标区间 */
+typedef struct {
+    pthread_mutex_t lock;
+    uint32_t next;                  // 下一个工作项，所有者从这里取
+    uint32_t end;                   // 区间终点，窃取者从这里切走后半段
+} acfs_work_range_t;
+
+typedef struct acfs_pool acfs_pool_t;
+
+/* 工作线程 */
+typedef struct {
+    acfs_pool_t* pool;
+    uint16_t index;                 // 工作线程序号，0为提交任务的线程
+    pthread_t thread;
+} acfs_pool_worker_t;
+
+/* 线程池 */
+struct acfs_pool {
+    pthread_mutex_t submit;         // 同一时刻只执行一批任务
+    pthread_mutex_t lock;
+    pthread_cond_t start;           // 新一批任务
+    pthread_cond_t done;            // 工作线程完成本批任务
+    uint32_t generation;            // 任务批次号
+    uint16_t running;               // 本批次未完成的工作线程数
+    bool stop;                      // 停止工作线程
+    acfs_task_t task;               // 本批次的任务
+    void* arg;                      // 任务参数
+    uint16_t workers;               // 工作线程数（含提交任务的线程）
+    acfs_work_range_t* ranges;      // 各工作线程的区间
+    acfs_pool_worker_t* threads;    // 工作线程1..workers-1
+};
+
+/**
+ * 取下一个工作项：先取自己的区间，空了再从其他线程窃取
+ */
+static bool acfs_pool_next(acfs_pool_t* pool, uint16_t worker, uint32_t* item)
+{
+    acfs_work_range_t* own = &pool->ranges[worker];
+    pthread_mutex_lock(&own->lock);
+    if (own->next < own->end) {
+        *item = own->next++;
+        pthread_mutex_unlock(&own->lock);
+        return true;
+    }
+    pthread_mutex_unlock(&own->lock);
+
+    for (uint16_t k = 1; k < pool->workers; k++) {
+        acfs_work_range_t* victim = &pool->ranges[(worker + k) % pool->workers];
+        pthread_mutex_lock(&victim->lock);
+        uint32_t left = victim->end - victim->next;
+        if (left == 0) {
+            pthread_mutex_unlock(&victim->lock);
+            continue;
+        }
+
+        uint32_t take = (left + 1) / 2;
+        uint32_t from = victim->end - take;
+        victim->end = from;
+        pthread_mutex_unlock(&victim->lock);
+
+        pthread_mutex_lock(&own->lock);
+        own->next = from + 1;
+        own->end = from + take;
+        pthread_mutex_unlock(&own->lock);
+
+        *item = from;
+        return true;
+    }
+
+    return false;
+}
+
+static void acfs_pool_drain(acfs_pool_t* pool, uint16_t worker)
+{
+    uint32_t item;
+    while (acfs_pool_next(pool, worker, &item)) {
+        pool->task(pool->arg, item, worker);
+    }
+}
+
+static void* acfs_pool_main(void* p)
+{
+    acfs_pool_worker_t* worker = (acfs_pool_worker_t*)p;
+    acfs_pool_t* pool = worker->pool;
+    uint32_t seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stop && pool->generation == seen) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->stop) {
+            break;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        acfs_pool_drain(pool, worker->index);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->running == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+static void acfs_pool_parallel_for(void* executor, acfs_task_t task, void* arg, uint32_t count)
+{
+    acfs_pool_t* pool = (acfs_pool_t*)executor;
+    if (count == 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->submit);
+
+    // 按下标均分，工作线程在批次号变化前不访问区间
+    for (uint16_t w = 0; w < pool->workers; w++) {
+        pool->ranges[w].next = (uint32_t)((uint64_t)count * w / pool->workers);
+        pool->ranges[w].end = (uint32_t)((uint64_t)count * (w + 1) / pool->workers);
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->arg = arg;
+    pool->running = pool->workers - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    // 提交任务的线程作为0号工作线程参与执行
+    acfs_pool_drain(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->running > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    pthread_mutex_unlock(&pool->submit);
+}
+
+/**
+ * 停止并回收前started个工作线程
+ */
+static void acfs_pool_stop(acfs_pool_t* pool, uint16_t started)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (uint16_t i = 0; i < started; i++) {
+        pthread_join(pool->threads[i].thread, NULL);
+    }
+}
+
+static void acfs_pool_free(acfs_pool_t* pool)
+{
+    for (uint16_t w = 0; w < pool->workers; w++) {
+        pthread_mutex_destroy(&pool->ranges[w].lock);
+    }
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->start);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->submit);
+    free(pool->threads);
+    free(pool->ranges);
+    free(pool);
+}
+
+/**
+ * 创建内置执行器
+ */
+acfs_error_t acfs_executor_create(acfs_executor_t* executor, uint16_t workers)
+{
+    if (!executor || workers == 0) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+
+    acfs_pool_t* pool = (acfs_pool_t*)calloc(1, sizeof(acfs_pool_t));
+    if (!pool) {
+        return ACFS_ERROR_NO_SPACE;
+    }
+
+    pool->workers = workers;
+    pool->ranges = (acfs_work_range_t*)calloc(workers, sizeof(acfs_work_range_t));
+    pool->threads = (acfs_pool_worker_t*)calloc(workers, sizeof(acfs_pool_worker_t));
+    if (!pool->ranges || !pool->threads) {
+        free(pool->threads);
+        free(pool->ranges);
+        free(pool);
+        return ACFS_ERROR_NO_SPACE;
+    }
+
+    pthread_mutex_init(&pool->submit, NULL);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    for (uint16_t w = 0; w < workers; w++) {
+        pthread_mutex_init(&pool->ranges[w].lock, NULL);
+    }
+
+    for (uint16_t i = 0; i + 1 < workers; i++) {
+        pool->threads[i].pool = pool;
+        pool->threads[i].index = i + 1;
+        if (pthread_create(&pool->threads[i].thread, NULL, acfs_pool_main, &pool->threads[i]) != 0) {
+            acfs_pool_stop(pool, i);
+            acfs_pool_free(pool);
+            return ACFS_ERROR_NO_SPACE;
+        }
+    }
+
+    executor->parallel_for = acfs_pool_parallel_for;
+    executor->workers = workers;
+    executor->context = pool;
+    return ACFS_OK;
+}
+
+/**
+ * 销毁内置执行器
+ */
+acfs_error_t acfs_executor_destroy(acfs_executor_t* executor)
+{
+    if (!executor || executor->parallel_for != acfs_pool_parallel_for || !executor->context) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+
+    acfs_pool_t* pool = (acfs_pool_t*)executor->context;
+    acfs_pool_stop(pool, pool->workers - 1);
+    acfs_pool_free(pool);
+
+    executor->parallel_for = NULL;
+    executor->workers = 0;
+    executor->context = NULL;
+    return ACFS_OK;
+}
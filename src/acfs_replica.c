@@ -0,0 +1,205 @@
+#include "../include/acfs.h"
+#include <string.h>
+#include <stdlib.h>
+
+/* 本地复制器：通过变更日志把源实例镜像到目标实例 */
+
+/* 全量同步时收集目标端多余条目 */
+typedef struct {
+    acfs_t* source;
+    char (*ids)[ACFS_MAX_DATA_ID_LEN];
+    uint16_t count;
+    uint16_t capacity;
+} acfs_replica_stale_t;
+
+/**
+ * 确保值缓冲区足够大
+ */
+static acfs_error_t acfs_replica_reserve(acfs_replica_t* replica, size_t size)
+{
+    if (replica->buffer_size >= size) {
+        return ACFS_OK;
+    }
+    
+    uint8_t* buffer = (uint8_t*)realloc(replica->buffer, size);
+    if (!buffer) {
+        return ACFS_ERROR_NO_SPACE;
+    }
+    
+    replica->buffer = buffer;
+    replica->buffer_size = size;
+    return ACFS_OK;
+}
+
+/**
+ * 把源端当前值复制到目标端；环形记录、队列和计数器不复制，计入skipped
+ */
+static acfs_error_t acfs_replica_copy(acfs_replica_t* replica, const char* data_id)
+{
+    acfs_stat_t info;
+    acfs_error_t ret = acfs_stat(replica->source, data_id, &info);
+    if (ret == ACFS_ERROR_DATA_NOT_FOUND) {
+        // 已被后续变更删除，等待删除记录
+        return ACFS_OK;
+    }
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    if (info.type != ACFS_TYPE_VALUE) {
+        replica->skipped++;
+        return ACFS_OK;
+    }
+    
+    ret = acfs_replica_reserve(replica, info.size);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    size_t actual_size;
+    ret = acfs_read(replica->source, data_id, replica->buffer, replica->buffer_size, &actual_size);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    return acfs_write(replica->target, data_id, replica->buffer, actual_size);
+}
+
+static acfs_error_t acfs_replica_apply(const acfs_change_record_t* record, void* user_data)
+{
+    acfs_replica_t* replica = (acfs_replica_t*)user_data;
+    acfs_error_t ret = ACFS_OK;
+    
+    if (record->type != ACFS_TYPE_VALUE) {
+        // 环形记录、队列和计数器就地更新不记入变更日志，无法增量复制，只计数并推进序列号
+        replica->skipped++;
+    } else if (record->op == ACFS_CHANGE_WRITE) {
+        ret = acfs_replica_copy(replica, record->data_id);
+    } else if (record->op == ACFS_CHANGE_DELETE) {
+        ret = acfs_delete(replica->target, record->data_id);
+        if (ret == ACFS_ERROR_DATA_NOT_FOUND) {
+            ret = ACFS_OK;
+        }
+    }
+    
+    if (ret == ACFS_OK) {
+        replica->sequence = record->sequence;
+    }
+    return ret;
+}
+
+static acfs_error_t acfs_replica_collect_stale(const char* data_id, size_t size, void* user_data)
+{
+    acfs_replica_stale_t* stale = (acfs_replica_stale_t*)user_data;
+    (void)size;
+    
+    if (acfs_exists(stale->source, data_id)) {
+        return ACFS_OK;
+    }
+    
+    if (stale->count == stale->capacity) {
+        uint16_t capacity = stale->capacity ? stale->capacity * 2 : 8;
+        char (*ids)[ACFS_MAX_DATA_ID_LEN] = realloc(stale->ids, capacity * sizeof(*ids));
+        if (!ids) {
+            return ACFS_ERROR_NO_SPACE;
+        }
+        stale->ids = ids;
+        stale->capacity = capacity;
+    }
+    
+    memcpy(stale->ids[stale->count++], data_id, ACFS_MAX_DATA_ID_LEN);
+    return ACFS_OK;
+}
+
+static acfs_error_t acfs_replica_copy_entry(const char* data_id, size_t size, void* user_data)
+{
+    (void)size;
+    return acfs_replica_copy((acfs_replica_t*)user_data, data_id);
+}
+
+/**
+ * 全量同步：删除目标端多余条目，复制源端全部条目
+ */
+static acfs_error_t acfs_replica_full_sync(acfs_replica_t* replica)
+{
+    uint32_t sequence;
+    acfs_error_t ret = acfs_get_sequence(replica->source, &sequence);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    acfs_replica_stale_t stale;
+    memset(&stale, 0, sizeof(stale));
+    stale.source = replica->source;
+    
+    ret = acfs_foreach(replica->target, acfs_replica_collect_stale, &stale);
+    for (uint16_t i = 0; ret == ACFS_OK && i < stale.count; i++) {
+        ret = acfs_delete(replica->target, stale.ids[i]);
+    }
+    free(stale.ids);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    ret = acfs_foreach(replica->source, acfs_replica_copy_entry, replica);
+    if (ret != ACFS_OK) {
+        return ret;
+    }
+    
+    replica->sequence = sequence;
+    return ACFS_OK;
+}
+
+/**
+ * 初始化复制器
+ */
+acfs_error_t acfs_replica_init(acfs_replica_t* replica, acfs_t* source, acfs_t* target)
+{
+    if (!replica || !source || !target || source == target) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!source->initialized || !target->initialized) {
+        return ACFS_ERROR_NOT_INITIALIZED;
+    }
+    
+    memset(replica, 0, sizeof(acfs_replica_t));
+    replica->source = source;
+    replica->target = target;
+    replica->need_full_sync = true;
+    return ACFS_OK;
+}
+
+/**
+ * 同步源端的新变更到目标端
+ */
+acfs_error_t acfs_replica_sync(acfs_replica_t* replica)
+{
+    if (!replica || !replica->source || !replica->target) {
+        return ACFS_ERROR_INVALID_PARAM;
+    }
+    
+    if (!replica->need_full_sync) {
+        acfs_error_t ret = acfs_changes_since(replica->source, replica->sequence, acfs_replica_apply, replica);
+        if (ret != ACFS_ERROR_LOG_TRUNCATED) {
+            return ret;
+        }
+    }
+    
+    // 首次同步或日志已截断，退回全量同步
+    acfs_error_t ret = acfs_replica_full_sync(replica);
+    replica->need_full_sync = (ret != ACFS_OK);
+    return ret;
+}
+
+/**
+ * 释放复制器资源
+ */
+void acfs_replica_deinit(acfs_replica_t* replica)
+{
+    if (!replica) {
+        return;
+    }
+    
+    free(replica->buffer);
+    memset(replica, 0, sizeof(acfs_replica_t));
+}
@@ -1,5 +1,6 @@
 #include "../include/acfs.h"
 #include <string.h>
+#include <stdlib.h>
 
 /* 模拟的EEPROM存储 */
 static uint8_t* eeprom_buffer = NULL;
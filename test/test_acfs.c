@@ -7,6 +7,18 @@
 acfs_error_t acfs_create_eeprom_device(storage_device_t* device, uint32_t start_addr, uint32_t size);
 void acfs_destroy_storage_device(storage_device_t* device);
 
+/* 1.x版本的头部布局 */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t cluster_size;
+    uint16_t total_clusters;
+    uint16_t sys_clusters;
+    uint16_t data_entries;
+    uint16_t free_clusters;
+    uint32_t crc32;
+} __attribute__((packed)) test_header_v1_t;
+
 /**
  * 测试基本初始化和格式化
  */
@@ -26,12 +38,46 @@ void test_init_format()
     };
     
     acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
     ret = acfs_init(&acfs, &storage, &config);
     assert(ret == ACFS_OK);
+    assert(acfs_write(&acfs, "data", "value", 6) == ACFS_OK);
     
     ret = acfs_deinit(&acfs);
     assert(ret == ACFS_OK);
     
+    acfs_header_t header;
+    assert(storage.ops.read(0, &header, sizeof(header)) == 0);
+    assert(header.version == ((ACFS_VERSION_MAJOR << 8) | ACFS_VERSION_MINOR));
+    
+    // 1.x版本的20字节头部：拒绝挂载和重建，卷内容不被改写；允许格式化时重新格式化
+    test_header_v1_t v1 = {
+        .magic = ACFS_MAGIC_NUMBER,
+        .version = 1 << 8,
+        .cluster_size = 128,
+        .total_clusters = 256,
+        .sys_clusters = 2,
+        .data_entries = 0,
+        .free_clusters = 254
+    };
+    v1.crc32 = acfs_crc32(&v1, sizeof(v1) - sizeof(uint32_t));
+    assert(storage.ops.write(0, &v1, sizeof(v1)) == 0);
+    
+    config.format_if_invalid = false;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_ERROR_INVALID_FILESYSTEM);
+    config.enable_cluster_trailer = true;
+    assert(acfs_fsck(&storage, &config, NULL) == ACFS_ERROR_INVALID_FILESYSTEM);
+    test_header_v1_t check;
+    assert(storage.ops.read(0, &check, sizeof(check)) == 0);
+    assert(memcmp(&check, &v1, sizeof(v1)) == 0);
+    
+    config.format_if_invalid = true;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    assert(!acfs_exists(&acfs, "data"));
+    assert(acfs_deinit(&acfs) == ACFS_OK);
+    
     acfs_destroy_storage_device(&storage);
     printf("✓ 初始化和格式化测试通过\n");
 }
@@ -54,6 +100,7 @@ void test_read_write()
     };
     
     acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
     acfs_init(&acfs, &storage, &config);
     
     // 测试写入
@@ -92,6 +139,7 @@ void test_exists()
     };
     
     acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
     acfs_init(&acfs, &storage, &config);
     
     // 测试不存在的数据
@@ -127,6 +175,7 @@ void test_delete()
     };
     
     acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
     acfs_init(&acfs, &storage, &config);
     
     // 写入数据
@@ -166,6 +215,7 @@ void test_stats()
     };
     
     acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
     acfs_init(&acfs, &storage, &config);
     
     size_t total_size, used_size, free_size;
@@ -208,6 +258,7 @@ void test_error_handling()
     };
     
     acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
     acfs_init(&acfs, &storage, &config);
     
     // 测试无效参数
@@ -231,6 +282,2498 @@ void test_error_handling()
     printf("✓ 错误处理测试通过\n");
 }
 
+/**
+ * 测试簇反向映射和碎片整理
+ */
+void test_cluster_owner()
+{
+    printf("测试: 簇反向映射\n");
+    
+    storage_device_t storage;
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 8,
+        .format_if_invalid = true,
+        .enable_crc_check = true
+    };
+    
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
+    acfs_init(&acfs, &storage, &config);
+    
+    uint8_t data_a[256];
+    uint8_t data_b[128];
+    memset(data_a, 0xA5, sizeof(data_a));
+    memset(data_b, 0x5A, sizeof(data_b));
+    
+    acfs_error_t ret = acfs_write(&acfs, "owner_a", data_a, sizeof(data_a));
+    assert(ret == ACFS_OK);
+    ret = acfs_write(&acfs, "owner_b", data_b, sizeof(data_b));
+    assert(ret == ACFS_OK);
+    
+    // 系统簇和空闲簇没有所属条目
+    uint16_t slot, index;
+    assert(acfs_get_cluster_owner(&acfs, 0, &slot, &index) == ACFS_ERROR_DATA_NOT_FOUND);
+    assert(acfs_get_cluster_owner(&acfs, 8, &slot, &index) == ACFS_OK);
+    assert(slot == 0 && index == 0);
+    assert(acfs_get_cluster_owner(&acfs, 9, &slot, &index) == ACFS_OK);
+    assert(slot == 0 && index == 1);
+    assert(acfs_get_cluster_owner(&acfs, 10, &slot, &index) == ACFS_OK);
+    assert(slot == 1 && index == 0);
+    
+    // 删除后槽位保留为删除标记，其余条目不移动
+    ret = acfs_delete(&acfs, "owner_a");
+    assert(ret == ACFS_OK);
+    assert(acfs_get_cluster_owner(&acfs, 8, &slot, &index) == ACFS_ERROR_DATA_NOT_FOUND);
+    assert(acfs_get_cluster_owner(&acfs, 10, &slot, &index) == ACFS_OK);
+    assert(slot == 1 && index == 0);
+    
+    // 碎片整理把数据搬到低地址
+    ret = acfs_defragment(&acfs);
+    assert(ret == ACFS_OK);
+    assert(acfs_get_cluster_owner(&acfs, 8, &slot, &index) == ACFS_OK);
+    assert(slot == 1 && index == 0);
+    assert(acfs_get_cluster_owner(&acfs, 10, &slot, &index) == ACFS_ERROR_DATA_NOT_FOUND);
+    
+    uint8_t read_buffer[128];
+    size_t actual_size;
+    ret = acfs_read(&acfs, "owner_b", read_buffer, sizeof(read_buffer), &actual_size);
+    assert(ret == ACFS_OK);
+    assert(memcmp(read_buffer, data_b, sizeof(data_b)) == 0);
+    
+    // 重新挂载后反向映射由条目表重建
+    acfs_deinit(&acfs);
+    ret = acfs_init(&acfs, &storage, &config);
+    assert(ret == ACFS_OK);
+    assert(acfs_get_cluster_owner(&acfs, 8, &slot, &index) == ACFS_OK);
+    assert(slot == 1 && index == 0);
+    
+    acfs_deinit(&acfs);
+    acfs_destroy_storage_device(&storage);
+    printf("✓ 簇反向映射测试通过\n");
+}
+
+/* 覆盖条目的首簇，用于模拟介质损坏或确认读取没有访问存储 */
+static void corrupt_first_cluster(acfs_t* acfs, storage_device_t* storage, const char* data_id)
+{
+    uint8_t garbage[128];
+    memset(garbage, 0xEE, sizeof(garbage));
+    for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
+        if (acfs->entries[i].is_valid && strcmp(acfs->entries[i].data_id, data_id) == 0) {
+            uint32_t addr = storage->start_addr + acfs->entries[i].cluster_list[0] * acfs->header.cluster_size;
+            storage->ops.write(addr, garbage, sizeof(garbage));
+        }
+    }
+}
+
+/**
+ * 测试簇尾部和元数据重建
+ */
+void test_fsck()
+{
+    printf("测试: 元数据重建\n");
+    
+    storage_device_t storage;
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 8,
+        .format_if_invalid = true,
+        .enable_crc_check = true,
+        .enable_cluster_trailer = true
+    };
+    
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
+    acfs_error_t ret = acfs_init(&acfs, &storage, &config);
+    assert(ret == ACFS_OK);
+    
+    uint8_t alpha[300];
+    uint8_t beta[50];
+    for (size_t i = 0; i < sizeof(alpha); i++) alpha[i] = (uint8_t)i;
+    memset(beta, 0x42, sizeof(beta));
+    
+    assert(acfs_write(&acfs, "alpha", alpha, 200) == ACFS_OK);
+    assert(acfs_write(&acfs, "beta", beta, sizeof(beta)) == ACFS_OK);
+    assert(acfs_write(&acfs, "gamma", beta, sizeof(beta)) == ACFS_OK);
+    assert(acfs_delete(&acfs, "gamma") == ACFS_OK);
+    assert(acfs_write(&acfs, "alpha", alpha, sizeof(alpha)) == ACFS_OK);
+    acfs_deinit(&acfs);
+    
+    // 破坏簇列表区域：挂载失败但不会被格式化
+    uint8_t garbage[4] = {0xDE, 0xAD, 0xBE, 0xEF};
+    uint32_t lists_addr = sizeof(acfs_header_t) + 2 * sizeof(acfs_data_entry_t);
+    storage.ops.write(lists_addr, garbage, sizeof(garbage));
+    ret = acfs_init(&acfs, &storage, &config);
+    assert(ret == ACFS_ERROR_DATA_CORRUPTED);
+    
+    // 重建后名称从旧条目表找回，已删除的数据不会复活
+    acfs_fsck_report_t report;
+    ret = acfs_fsck(&storage, &config, &report);
+    assert(ret == ACFS_OK);
+    assert(report.entries_recovered == 2);
+    assert(report.entries_unnamed == 0);
+    
+    memset(&acfs, 0, sizeof(acfs));
+    ret = acfs_init(&acfs, &storage, &config);
+    assert(ret == ACFS_OK);
+    assert(!acfs_exists(&acfs, "gamma"));
+    
+    uint8_t read_buffer[300];
+    size_t actual_size;
+    ret = acfs_read(&acfs, "alpha", read_buffer, sizeof(read_buffer), &actual_size);
+    assert(ret == ACFS_OK);
+    assert(actual_size == sizeof(alpha));
+    assert(memcmp(read_buffer, alpha, sizeof(alpha)) == 0);
+    ret = acfs_read(&acfs, "beta", read_buffer, sizeof(read_buffer), &actual_size);
+    assert(ret == ACFS_OK);
+    assert(memcmp(read_buffer, beta, sizeof(beta)) == 0);
+    acfs_deinit(&acfs);
+    
+    // 头部完全丢失时按配置推断布局，名称无法找回
+    uint8_t zero_header[sizeof(acfs_header_t)] = {0};
+    storage.ops.write(0, zero_header, sizeof(zero_header));
+    ret = acfs_fsck(&storage, &config, &report);
+    assert(ret == ACFS_OK);
+    assert(report.entries_recovered == 2);
+    assert(report.entries_unnamed == 2);
+    
+    ret = acfs_init(&acfs, &storage, &config);
+    assert(ret == ACFS_OK);
+    uint16_t data_count;
+    acfs_get_stats(&acfs, NULL, NULL, NULL, &data_count);
+    assert(data_count == 2);
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    
+    // 最新版本的簇损坏时同序号的旧版本簇会被拼入，数据CRC不符的条目被丢弃而不是恢复
+    uint8_t delta[200];
+    for (size_t i = 0; i < sizeof(delta); i++) delta[i] = (uint8_t)(0xFF - i);
+    assert(acfs_write(&acfs, "delta", alpha, sizeof(delta)) == ACFS_OK);
+    assert(acfs_snapshot_create(&acfs) == ACFS_OK);
+    assert(acfs_write(&acfs, "delta", delta, sizeof(delta)) == ACFS_OK);
+    assert(acfs_snapshot_delete(&acfs) == ACFS_OK);
+    corrupt_first_cluster(&acfs, &storage, "delta");
+    acfs_deinit(&acfs);
+    
+    ret = acfs_fsck(&storage, &config, &report);
+    assert(ret == ACFS_OK);
+    assert(report.entries_recovered == 2);
+    assert(report.entries_dropped == 1);
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    assert(!acfs_exists(&acfs, "delta"));
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    
+    acfs_deinit(&acfs);
+    acfs_destroy_storage_device(&storage);
+    printf("✓ 元数据重建测试通过\n");
+}
+
+static acfs_error_t count_change(const acfs_change_record_t* record, void* user_data)
+{
+    (void)record;
+    (*(uint16_t*)user_data)++;
+    return ACFS_OK;
+}
+
+/* 测试用的第二块RAM存储（EEPROM模拟器只有一个实例） */
+static uint8_t mirror_ram[32 * 1024];
+
+static int mirror_read(uint32_t addr, void* data, size_t size)
+{
+    if (addr + size > sizeof(mirror_ram)) return -1;
+    memcpy(data, mirror_ram + addr, size);
+    return 0;
+}
+
+static int mirror_write(uint32_t addr, const void* data, size_t size)
+{
+    if (addr + size > sizeof(mirror_ram)) return -1;
+    memcpy(mirror_ram + addr, data, size);
+    return 0;
+}
+
+static void create_mirror_device(storage_device_t* device)
+{
+    memset(mirror_ram, 0xFF, sizeof(mirror_ram));
+    memset(device, 0, sizeof(storage_device_t));
+    device->size = sizeof(mirror_ram);
+    device->type = STORAGE_TYPE_SDRAM;
+    device->ops.read = mirror_read;
+    device->ops.write = mirror_write;
+}
+
+/**
+ * 测试变更日志和本地复制
+ */
+void test_replica()
+{
+    printf("测试: 变更日志和本地复制\n");
+    
+    storage_device_t storage, mirror;
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    create_mirror_device(&mirror);
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 8,
+        .format_if_invalid = true,
+        .enable_crc_check = true,
+        .change_log_size = 8
+    };
+    
+    acfs_t source, target;
+    memset(&source, 0, sizeof(source));
+    memset(&target, 0, sizeof(target));
+    assert(acfs_init(&source, &storage, &config) == ACFS_OK);
+    assert(acfs_init(&target, &mirror, &config) == ACFS_OK);
+    
+    acfs_replica_t replica;
+    assert(acfs_replica_init(&replica, &source, &target) == ACFS_OK);
+    assert(acfs_write(&target, "stale", "x", 2) == ACFS_OK);
+    
+    // 首次同步为全量同步
+    assert(acfs_write(&source, "a", "value a", 8) == ACFS_OK);
+    assert(acfs_replica_sync(&replica) == ACFS_OK);
+    assert(acfs_exists(&target, "a"));
+    assert(!acfs_exists(&target, "stale"));
+    
+    // 之后只回放增量
+    uint32_t sequence;
+    acfs_get_sequence(&source, &sequence);
+    assert(acfs_write(&source, "b", "value b", 8) == ACFS_OK);
+    assert(acfs_delete(&source, "a") == ACFS_OK);
+    
+    uint16_t changes = 0;
+    assert(acfs_changes_since(&source, sequence, count_change, &changes) == ACFS_OK);
+    assert(changes == 2);
+    
+    assert(acfs_replica_sync(&replica) == ACFS_OK);
+    assert(!acfs_exists(&target, "a"));
+    
+    char buffer[16];
+    size_t actual_size;
+    assert(acfs_read(&target, "b", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(strcmp(buffer, "value b") == 0);
+    
+    // 日志被覆盖后回放报告截断，复制器退回全量同步
+    for (int i = 0; i < 10; i++) {
+        assert(acfs_write(&source, "c", &i, sizeof(i)) == ACFS_OK);
+    }
+    assert(acfs_changes_since(&source, sequence, count_change, &changes) == ACFS_ERROR_LOG_TRUNCATED);
+    assert(acfs_replica_sync(&replica) == ACFS_OK);
+    
+    int value;
+    assert(acfs_read(&target, "c", &value, sizeof(value), &actual_size) == ACFS_OK);
+    assert(value == 9);
+    
+    // 环形记录、队列和计数器不复制并计数，不阻塞之后的普通数据
+    assert(acfs_ring_create(&source, "ring", 8, 4) == ACFS_OK);
+    assert(acfs_ring_push(&source, "ring", "record1") == ACFS_OK);
+    assert(acfs_queue_create(&source, "queue") == ACFS_OK);
+    assert(acfs_queue_push(&source, "queue", "msg", 4) == ACFS_OK);
+    assert(acfs_counter_create(&source, "counter", 5) == ACFS_OK);
+    assert(acfs_counter_add(&source, "counter", 1, NULL) == ACFS_OK);
+    assert(acfs_write(&source, "d", "value d", 8) == ACFS_OK);
+    assert(acfs_replica_sync(&replica) == ACFS_OK);
+    assert(acfs_read(&target, "d", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(strcmp(buffer, "value d") == 0);
+    assert(!acfs_exists(&target, "ring") && !acfs_exists(&target, "queue") && !acfs_exists(&target, "counter"));
+    assert(replica.skipped == 3);
+    
+    assert(acfs_write(&source, "e", "value e", 8) == ACFS_OK);
+    assert(acfs_replica_sync(&replica) == ACFS_OK);
+    assert(acfs_exists(&target, "e"));
+    acfs_replica_deinit(&replica);
+    
+    // 全量同步同样跳过
+    assert(acfs_replica_init(&replica, &source, &target) == ACFS_OK);
+    assert(acfs_write(&source, "f", "value f", 8) == ACFS_OK);
+    assert(acfs_replica_sync(&replica) == ACFS_OK);
+    assert(acfs_exists(&target, "f") && !acfs_exists(&target, "counter"));
+    assert(replica.skipped == 3);
+    
+    acfs_replica_deinit(&replica);
+    acfs_deinit(&source);
+    acfs_deinit(&target);
+    acfs_destroy_storage_device(&storage);
+    printf("✓ 变更日志和本地复制测试通过\n");
+}
+
+/**
+ * 测试重命名
+ */
+void test_rename()
+{
+    printf("测试: 重命名\n");
+    
+    storage_device_t storage;
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 8,
+        .format_if_invalid = true,
+        .enable_crc_check = true,
+        .enable_cluster_trailer = true
+    };
+    
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    
+    size_t free_before, free_after;
+    acfs_get_free_space(&acfs, &free_before);
+    assert(acfs_write(&acfs, "cfg", "version 1", 10) == ACFS_OK);
+    assert(acfs_write(&acfs, "cfg.tmp", "version 2", 10) == ACFS_OK);
+    
+    assert(acfs_rename(&acfs, "missing", "cfg", true) == ACFS_ERROR_DATA_NOT_FOUND);
+    assert(acfs_rename(&acfs, "cfg.tmp", "cfg", false) == ACFS_ERROR_DATA_EXISTS);
+    
+    // 替换已有条目，被替换条目的簇释放
+    assert(acfs_rename(&acfs, "cfg.tmp", "cfg", true) == ACFS_OK);
+    assert(!acfs_exists(&acfs, "cfg.tmp"));
+    acfs_get_free_space(&acfs, &free_after);
+    assert(free_after == free_before - 128);
+    
+    char buffer[16];
+    size_t actual_size;
+    assert(acfs_read(&acfs, "cfg", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(strcmp(buffer, "version 2") == 0);
+    
+    // 改名到新标识
+    assert(acfs_rename(&acfs, "cfg", "config", false) == ACFS_OK);
+    assert(!acfs_exists(&acfs, "cfg"));
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    
+    // 簇尾部的所属标识不变，元数据重建后仍能找回新名称
+    acfs_deinit(&acfs);
+    assert(acfs_fsck(&storage, &config, NULL) == ACFS_OK);
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    assert(acfs_read(&acfs, "config", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(strcmp(buffer, "version 2") == 0);
+    assert(!acfs_exists(&acfs, "cfg"));
+    
+    acfs_deinit(&acfs);
+    acfs_destroy_storage_device(&storage);
+    printf("✓ 重命名测试通过\n");
+}
+
+/**
+ * 测试按版本号写入
+ */
+void test_write_if_version()
+{
+    printf("测试: 按版本号写入\n");
+    
+    storage_device_t storage;
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 8,
+        .format_if_invalid = true,
+        .enable_crc_check = true
+    };
+    
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    
+    // 版本号0表示只在不存在时创建
+    uint32_t version, created;
+    int value = 1;
+    assert(acfs_write_if_version(&acfs, "counter", 0, &value, sizeof(value), &created) == ACFS_OK);
+    assert(acfs_write_if_version(&acfs, "counter", 0, &value, sizeof(value), NULL) == ACFS_ERROR_VERSION_MISMATCH);
+    
+    size_t actual_size;
+    assert(acfs_read_version(&acfs, "counter", &value, sizeof(value), &actual_size, &version) == ACFS_OK);
+    assert(version == created);
+    
+    // 两个读者基于同一版本修改，后提交的失败
+    int first = value + 1;
+    int second = value + 10;
+    assert(acfs_write_if_version(&acfs, "counter", version, &first, sizeof(first), NULL) == ACFS_OK);
+    assert(acfs_write_if_version(&acfs, "counter", version, &second, sizeof(second), NULL) == ACFS_ERROR_VERSION_MISMATCH);
+    
+    // 重新读取后重试成功
+    assert(acfs_read_version(&acfs, "counter", &value, sizeof(value), &actual_size, &version) == ACFS_OK);
+    assert(value == 2);
+    value += 10;
+    assert(acfs_write_if_version(&acfs, "counter", version, &value, sizeof(value), NULL) == ACFS_OK);
+    
+    // 版本号随元数据持久化
+    acfs_read_version(&acfs, "counter", &value, sizeof(value), &actual_size, &version);
+    acfs_deinit(&acfs);
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    uint32_t reloaded;
+    assert(acfs_read_version(&acfs, "counter", &value, sizeof(value), &actual_size, &reloaded) == ACFS_OK);
+    assert(reloaded == version && value == 12);
+    
+    // 删除后版本号回到0
+    assert(acfs_delete(&acfs, "counter") == ACFS_OK);
+    assert(acfs_write_if_version(&acfs, "counter", version, &value, sizeof(value), NULL) == ACFS_ERROR_VERSION_MISMATCH);
+    assert(acfs_write_if_version(&acfs, "counter", 0, &value, sizeof(value), NULL) == ACFS_OK);
+    
+    acfs_deinit(&acfs);
+    acfs_destroy_storage_device(&storage);
+    printf("✓ 按版本号写入测试通过\n");
+}
+
+/* 模拟写入失败：地址低于阈值的写入返回错误 */
+static int (*failing_write_next)(uint32_t addr, const void* data, size_t size);
+static uint32_t failing_write_below;
+
+static int failing_write(uint32_t addr, const void* data, size_t size)
+{
+    if (addr < failing_write_below) {
+        return -1;
+    }
+    return failing_write_next(addr, data, size);
+}
+
+/* 回滚失败后内存中的条目应与失败前一致 */
+static void check_unrestored(acfs_t* acfs, size_t free_expected)
+{
+    char buffer[16];
+    size_t actual_size, free_space;
+    assert(acfs_read(acfs, "cfg", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(strcmp(buffer, "version 2") == 0);
+    assert(acfs_exists(acfs, "new"));
+    assert(!acfs_exists(acfs, "large"));
+    assert(acfs_check_integrity(acfs) == ACFS_OK);
+    acfs_get_free_space(acfs, &free_space);
+    assert(free_space == free_expected);
+}
+
+/**
+ * 测试卷快照
+ */
+void test_snapshot()
+{
+    printf("测试: 卷快照\n");
+    
+    storage_device_t storage;
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 8,
+        .format_if_invalid = true,
+        .enable_crc_check = true,
+        .enable_cluster_trailer = true
+    };
+    
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    assert(acfs_snapshot_restore(&acfs) == ACFS_ERROR_DATA_NOT_FOUND);
+    
+    uint8_t large[300];
+    memset(large, 0x3C, sizeof(large));
+    assert(acfs_write(&acfs, "cfg", "version 1", 10) == ACFS_OK);
+    assert(acfs_write(&acfs, "large", large, sizeof(large)) == ACFS_OK);
+    
+    // 创建快照不占用数据簇
+    size_t free_before, free_after;
+    acfs_get_free_space(&acfs, &free_before);
+    assert(acfs_snapshot_create(&acfs) == ACFS_OK);
+    acfs_get_free_space(&acfs, &free_after);
+    assert(free_after == free_before);
+    
+    // 快照之后的修改写到新簇，被快照引用的簇不回收
+    assert(acfs_write(&acfs, "cfg", "version 2", 10) == ACFS_OK);
+    assert(acfs_write(&acfs, "new", "n", 2) == ACFS_OK);
+    assert(acfs_delete(&acfs, "large") == ACFS_OK);
+    acfs_get_free_space(&acfs, &free_after);
+    assert(free_after == free_before - 2 * 128);
+    
+    char buffer[16];
+    size_t actual_size;
+    assert(acfs_read(&acfs, "cfg", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(strcmp(buffer, "version 2") == 0);
+    
+    // 快照随元数据持久化，回滚后恢复快照时的全部条目
+    acfs_deinit(&acfs);
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    
+    // 标记删除或提交元数据失败时，回滚不改变内存中的条目表
+    failing_write_next = storage.ops.write;
+    storage.ops.write = failing_write;
+    failing_write_below = 0xFFFFFFFF;
+    assert(acfs_snapshot_restore(&acfs) == ACFS_ERROR_IO_ERROR);
+    check_unrestored(&acfs, free_before - 2 * 128);
+    failing_write_below = 8 * 128;
+    assert(acfs_snapshot_restore(&acfs) == ACFS_ERROR_IO_ERROR);
+    check_unrestored(&acfs, free_before - 2 * 128);
+    storage.ops.write = failing_write_next;
+    
+    assert(acfs_snapshot_restore(&acfs) == ACFS_OK);
+    
+    uint8_t large_read[300];
+    assert(acfs_read(&acfs, "cfg", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(strcmp(buffer, "version 1") == 0);
+    assert(acfs_read(&acfs, "large", large_read, sizeof(large_read), &actual_size) == ACFS_OK);
+    assert(memcmp(large, large_read, sizeof(large)) == 0);
+    assert(!acfs_exists(&acfs, "new"));
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    acfs_get_free_space(&acfs, &free_after);
+    assert(free_after == free_before);
+    
+    // 删除快照后恢复原地覆盖
+    assert(acfs_snapshot_delete(&acfs) == ACFS_OK);
+    assert(acfs_snapshot_delete(&acfs) == ACFS_ERROR_DATA_NOT_FOUND);
+    uint16_t slot, index;
+    assert(acfs_get_cluster_owner(&acfs, 8, &slot, &index) == ACFS_OK);
+    assert(acfs_write(&acfs, "cfg", "version 3", 10) == ACFS_OK);
+    assert(acfs_get_cluster_owner(&acfs, 8, &slot, &index) == ACFS_OK);
+    acfs_get_free_space(&acfs, &free_after);
+    assert(free_after == free_before);
+    
+    acfs_deinit(&acfs);
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    assert(acfs_read(&acfs, "cfg", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(strcmp(buffer, "version 3") == 0);
+    
+    // 回滚后重建元数据不会撤销回滚：覆盖、改名和删除的条目回到快照时的版本
+    assert(acfs_write(&acfs, "keep", "k", 2) == ACFS_OK);
+    assert(acfs_snapshot_create(&acfs) == ACFS_OK);
+    assert(acfs_write(&acfs, "cfg", "version 4", 10) == ACFS_OK);
+    assert(acfs_write(&acfs, "cfg", "version 5", 10) == ACFS_OK);
+    assert(acfs_rename(&acfs, "large", "moved", false) == ACFS_OK);
+    assert(acfs_delete(&acfs, "keep") == ACFS_OK);
+    assert(acfs_write(&acfs, "later", "l", 2) == ACFS_OK);
+    assert(acfs_snapshot_restore(&acfs) == ACFS_OK);
+    acfs_deinit(&acfs);
+    
+    acfs_fsck_report_t report;
+    assert(acfs_fsck(&storage, &config, &report) == ACFS_OK);
+    assert(report.entries_dropped == 0);
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    assert(acfs_read(&acfs, "cfg", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(strcmp(buffer, "version 3") == 0);
+    assert(acfs_read(&acfs, "large", large_read, sizeof(large_read), &actual_size) == ACFS_OK);
+    assert(memcmp(large, large_read, sizeof(large)) == 0);
+    assert(acfs_read(&acfs, "keep", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(strcmp(buffer, "k") == 0);
+    assert(!acfs_exists(&acfs, "moved"));
+    assert(!acfs_exists(&acfs, "later"));
+    assert(!acfs_exists(&acfs, "new"));
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    
+    // 快照占住空间时覆盖共享的条目失败，条目保持原值
+    assert(acfs_snapshot_create(&acfs) == ACFS_OK);
+    acfs_get_free_space(&acfs, &free_after);
+    assert(acfs_reserve(&acfs, "fill", free_after / 128 * (128 - sizeof(acfs_cluster_trailer_t))) == ACFS_OK);
+    assert(acfs_write(&acfs, "cfg", "version 6", 10) == ACFS_ERROR_NO_SPACE);
+    assert(acfs_read(&acfs, "cfg", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(strcmp(buffer, "version 3") == 0);
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    assert(acfs_snapshot_delete(&acfs) == ACFS_OK);
+    assert(acfs_write(&acfs, "cfg", "version 6", 10) == ACFS_OK);
+    
+    acfs_deinit(&acfs);
+    acfs_destroy_storage_device(&storage);
+    printf("✓ 卷快照测试通过\n");
+}
+
+/* 测试用的内存归档流 */
+typedef struct {
+    uint8_t data[8 * 1024];
+    size_t size;
+    size_t pos;
+    acfs_t* acfs;               // 非NULL时在首次输出时修改源实例
+} test_stream_t;
+
+static int stream_write(const void* data, size_t size, void* user_data)
+{
+    test_stream_t* stream = (test_stream_t*)user_data;
+    if (stream->size + size > sizeof(stream->data)) return -1;
+    memcpy(stream->data + stream->size, data, size);
+    stream->size += size;
+    
+    if (stream->acfs) {
+        // 导出期间的写入和删除不影响导出内容
+        acfs_t* acfs = stream->acfs;
+        stream->acfs = NULL;
+        assert(acfs_write(acfs, "a", "changed", 8) == ACFS_OK);
+        assert(acfs_delete(acfs, "b") == ACFS_OK);
+        assert(acfs_defragment(acfs) == ACFS_ERROR_BUSY);
+    }
+    return 0;
+}
+
+static int stream_read(void* data, size_t size, void* user_data)
+{
+    test_stream_t* stream = (test_stream_t*)user_data;
+    if (stream->pos + size > stream->size) return -1;
+    memcpy(data, stream->data + stream->pos, size);
+    stream->pos += size;
+    return 0;
+}
+
+/**
+ * 测试流式导出和导入
+ */
+void test_export_import()
+{
+    printf("测试: 流式导出和导入\n");
+    
+    storage_device_t storage, mirror;
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    create_mirror_device(&mirror);
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 8,
+        .format_if_invalid = true,
+        .enable_crc_check = true,
+        .enable_cluster_trailer = true
+    };
+    
+    acfs_t source, target;
+    memset(&source, 0, sizeof(source));
+    memset(&target, 0, sizeof(target));
+    assert(acfs_init(&source, &storage, &config) == ACFS_OK);
+    assert(acfs_init(&target, &mirror, &config) == ACFS_OK);
+    
+    uint8_t large[300];
+    for (size_t i = 0; i < sizeof(large); i++) {
+        large[i] = (uint8_t)(i * 7);
+    }
+    assert(acfs_write(&source, "a", "original", 9) == ACFS_OK);
+    assert(acfs_write(&source, "b", large, sizeof(large)) == ACFS_OK);
+    
+    size_t free_before;
+    acfs_get_free_space(&source, &free_before);
+    
+    static test_stream_t stream;
+    memset(&stream, 0, sizeof(stream));
+    stream.acfs = &source;
+    assert(acfs_export(&source, stream_write, &stream) == ACFS_OK);
+    
+    // 解冻后被覆盖和删除的簇已回收
+    size_t free_after;
+    acfs_get_free_space(&source, &free_after);
+    assert(free_after > free_before);
+    assert(!acfs_exists(&source, "b"));
+    assert(acfs_check_integrity(&source) == ACFS_OK);
+    
+    // 导入得到导出开始时的快照
+    assert(acfs_import(&target, stream_read, &stream) == ACFS_OK);
+    
+    char buffer[16];
+    uint8_t large_read[300];
+    size_t actual_size;
+    assert(acfs_read(&target, "a", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(strcmp(buffer, "original") == 0);
+    assert(acfs_read(&target, "b", large_read, sizeof(large_read), &actual_size) == ACFS_OK);
+    assert(actual_size == sizeof(large));
+    assert(memcmp(large, large_read, sizeof(large)) == 0);
+    
+    // 损坏的归档被拒绝
+    stream.pos = 0;
+    stream.data[stream.size - 20] ^= 0xFF;
+    assert(acfs_import(&target, stream_read, &stream) == ACFS_ERROR_CRC_MISMATCH);
+    
+    // 导出和导入包括环形记录、队列和计数器；它们就地更新，增量导出也总是包含
+    acfs_deinit(&source);
+    acfs_deinit(&target);
+    config.enable_cluster_trailer = false;
+    acfs_destroy_storage_device(&storage);
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    create_mirror_device(&mirror);
+    memset(&source, 0, sizeof(source));
+    memset(&target, 0, sizeof(target));
+    assert(acfs_init(&source, &storage, &config) == ACFS_OK);
+    assert(acfs_init(&target, &mirror, &config) == ACFS_OK);
+    assert(acfs_ring_create(&source, "ring", 8, 4) == ACFS_OK);
+    assert(acfs_ring_push(&source, "ring", "record1") == ACFS_OK);
+    assert(acfs_queue_create(&source, "queue") == ACFS_OK);
+    assert(acfs_queue_push(&source, "queue", "msg", 4) == ACFS_OK);
+    assert(acfs_counter_create(&source, "counter", 5) == ACFS_OK);
+    assert(acfs_counter_add(&source, "counter", 1, NULL) == ACFS_OK);
+    
+    uint32_t sequence;
+    acfs_get_sequence(&source, &sequence);
+    memset(&stream, 0, sizeof(stream));
+    assert(acfs_export_since(&source, sequence, stream_write, &stream) == ACFS_OK);
+    assert(acfs_import(&target, stream_read, &stream) == ACFS_OK);
+    
+    char records[4][8];
+    uint32_t count;
+    assert(acfs_ring_push(&source, "ring", "record2") == ACFS_OK);
+    assert(acfs_ring_read_range(&target, "ring", records, 4, &count) == ACFS_OK && count == 1);
+    assert(strcmp(records[0], "record1") == 0);
+    assert(acfs_ring_push(&target, "ring", "record3") == ACFS_OK);
+    assert(acfs_queue_pop(&target, "queue", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(actual_size == 4 && strcmp(buffer, "msg") == 0);
+    uint64_t counter;
+    assert(acfs_counter_add(&target, "counter", 1, &counter) == ACFS_OK && counter == 7);
+    assert(acfs_check_integrity(&target) == ACFS_OK);
+    
+    // 重新导入取代目标端的同名条目
+    memset(&stream, 0, sizeof(stream));
+    assert(acfs_export(&source, stream_write, &stream) == ACFS_OK);
+    assert(acfs_import(&target, stream_read, &stream) == ACFS_OK);
+    assert(acfs_ring_read_range(&target, "ring", records, 4, &count) == ACFS_OK && count == 2);
+    assert(strcmp(records[1], "record2") == 0);
+    assert(acfs_counter_get(&target, "counter", &counter) == ACFS_OK && counter == 6);
+    assert(acfs_queue_length(&target, "queue", &count) == ACFS_OK && count == 1);
+    
+    // 启用簇尾部的卷不能导入这些类型
+    acfs_deinit(&target);
+    config.enable_cluster_trailer = true;
+    create_mirror_device(&mirror);
+    memset(&target, 0, sizeof(target));
+    assert(acfs_init(&target, &mirror, &config) == ACFS_OK);
+    stream.pos = 0;
+    assert(acfs_import(&target, stream_read, &stream) == ACFS_ERROR_INVALID_PARAM);
+    
+    acfs_deinit(&source);
+    acfs_deinit(&target);
+    acfs_destroy_storage_device(&storage);
+    printf("✓ 流式导出和导入测试通过\n");
+}
+
+/**
+ * 测试增量导出
+ */
+void test_export_since()
+{
+    printf("测试: 增量导出\n");
+    
+    storage_device_t storage, mirror;
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    create_mirror_device(&mirror);
+    
+    // 5个系统簇只容纳3个条目，便于触发删除标记清除
+    acfs_config_t config = {
+        .cluster_size = 64,
+        .reserved_clusters = 5,
+        .format_if_invalid = true,
+        .enable_crc_check = true
+    };
+    
+    acfs_t source, target;
+    memset(&source, 0, sizeof(source));
+    memset(&target, 0, sizeof(target));
+    assert(acfs_init(&source, &storage, &config) == ACFS_OK);
+    assert(acfs_init(&target, &mirror, &config) == ACFS_OK);
+    
+    assert(acfs_write(&source, "a", "value a", 8) == ACFS_OK);
+    assert(acfs_write(&source, "b", "value b", 8) == ACFS_OK);
+    
+    static test_stream_t stream;
+    memset(&stream, 0, sizeof(stream));
+    uint32_t base;
+    acfs_get_sequence(&source, &base);
+    assert(acfs_export(&source, stream_write, &stream) == ACFS_OK);
+    assert(acfs_import(&target, stream_read, &stream) == ACFS_OK);
+    
+    // 增量只包含修改和删除
+    assert(acfs_write(&source, "b", "new b", 6) == ACFS_OK);
+    assert(acfs_delete(&source, "a") == ACFS_OK);
+    memset(&stream, 0, sizeof(stream));
+    assert(acfs_export_since(&source, base, stream_write, &stream) == ACFS_OK);
+    assert(stream.size == sizeof(acfs_archive_header_t) + 2 * sizeof(acfs_archive_record_t) + 6 +
+                          sizeof(acfs_archive_footer_t));
+    assert(acfs_import(&target, stream_read, &stream) == ACFS_OK);
+    
+    char buffer[16];
+    size_t actual_size;
+    assert(!acfs_exists(&target, "a"));
+    assert(acfs_read(&target, "b", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(strcmp(buffer, "new b") == 0);
+    
+    // 删除标记不计入条目数，同名写入复用其槽位
+    uint16_t data_count;
+    acfs_get_stats(&source, NULL, NULL, NULL, &data_count);
+    assert(data_count == 1);
+    
+    // 条目表满时清除最旧的删除标记，更早的起点只能全量导出
+    assert(acfs_write(&source, "c", "value c", 8) == ACFS_OK);
+    assert(acfs_write(&source, "d", "value d", 8) == ACFS_OK);
+    memset(&stream, 0, sizeof(stream));
+    assert(acfs_export_since(&source, base, stream_write, &stream) == ACFS_ERROR_LOG_TRUNCATED);
+    
+    uint32_t sequence;
+    acfs_get_sequence(&source, &sequence);
+    assert(acfs_export_since(&source, sequence, stream_write, &stream) == ACFS_OK);
+    assert(stream.size == sizeof(acfs_archive_header_t) + sizeof(acfs_archive_footer_t));
+    
+    // 修改序列号和删除标记随元数据持久化
+    acfs_deinit(&source);
+    memset(&source, 0, sizeof(source));
+    assert(acfs_init(&source, &storage, &config) == ACFS_OK);
+    assert(acfs_export_since(&source, base, stream_write, &stream) == ACFS_ERROR_LOG_TRUNCATED);
+    
+    acfs_deinit(&source);
+    acfs_deinit(&target);
+    acfs_destroy_storage_device(&storage);
+    printf("✓ 增量导出测试通过\n");
+}
+
+static uint32_t fake_now = 1000;
+
+static uint32_t fake_time(void)
+{
+    return fake_now;
+}
+
+void test_ttl()
+{
+    printf("测试: 过期数据\n");
+    
+    storage_device_t storage;
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 8,
+        .format_if_invalid = true,
+        .enable_crc_check = true
+    };
+    
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    
+    // 没有时间源时不能设置有效期
+    char data[200];
+    memset(data, 0x5A, sizeof(data));
+    assert(acfs_write_ttl(&acfs, "session", data, sizeof(data), 10) == ACFS_ERROR_INVALID_PARAM);
+    acfs_deinit(&acfs);
+    
+    config.get_time = fake_time;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    
+    size_t free_before, free_after;
+    uint16_t data_count, reclaimed;
+    acfs_get_stats(&acfs, NULL, NULL, &free_before, &data_count);
+    
+    assert(acfs_write_ttl(&acfs, "session", data, sizeof(data), 10) == ACFS_OK);
+    assert(acfs_write_ttl(&acfs, "token", data, 50, 30) == ACFS_OK);
+    assert(acfs_write(&acfs, "config", data, 50) == ACFS_OK);
+    
+    // 未到期前正常可见，回收不做任何事
+    assert(acfs_exists(&acfs, "session"));
+    assert(acfs_expire(&acfs, 0, &reclaimed) == ACFS_OK && reclaimed == 0);
+    
+    // 到期后立即不可见，空间要等回收
+    fake_now += 10;
+    char buffer[200];
+    size_t actual_size;
+    assert(!acfs_exists(&acfs, "session"));
+    assert(acfs_read(&acfs, "session", buffer, sizeof(buffer), &actual_size) == ACFS_ERROR_DATA_NOT_FOUND);
+    acfs_get_stats(&acfs, NULL, NULL, &free_after, &data_count);
+    assert(data_count == 2);
+    assert(free_after < free_before);
+    
+    // 过期时间随元数据持久化
+    acfs_deinit(&acfs);
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    assert(!acfs_exists(&acfs, "session"));
+    assert(acfs_exists(&acfs, "token"));
+    
+    // 普通写入清除过期时间
+    assert(acfs_write_ttl(&acfs, "config", data, 50, 5) == ACFS_OK);
+    assert(acfs_write(&acfs, "config", data, 50) == ACFS_OK);
+    
+    // 按批回收，按过期时间顺序进行
+    fake_now += 100;
+    assert(acfs_expire(&acfs, 1, &reclaimed) == ACFS_OK && reclaimed == 1);
+    assert(acfs_expire(&acfs, 0, &reclaimed) == ACFS_OK && reclaimed == 1);
+    assert(acfs_expire(&acfs, 0, &reclaimed) == ACFS_OK && reclaimed == 0);
+    assert(acfs_exists(&acfs, "config"));
+    
+    acfs_get_stats(&acfs, NULL, NULL, &free_after, &data_count);
+    assert(data_count == 1);
+    
+    // 回收结果已提交
+    acfs_deinit(&acfs);
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    size_t free_reloaded;
+    acfs_get_stats(&acfs, NULL, NULL, &free_reloaded, &data_count);
+    assert(free_reloaded == free_after && data_count == 1);
+    
+    // 导入与普通写入一样清除过期时间
+    static test_stream_t stream;
+    memset(&stream, 0, sizeof(stream));
+    assert(acfs_export(&acfs, stream_write, &stream) == ACFS_OK);
+    assert(acfs_write_ttl(&acfs, "config", data, 50, 5) == ACFS_OK);
+    assert(acfs_import(&acfs, stream_read, &stream) == ACFS_OK);
+    fake_now += 10;
+    assert(acfs_exists(&acfs, "config"));
+    assert(acfs_expire(&acfs, 0, &reclaimed) == ACFS_OK && reclaimed == 0);
+    
+    acfs_deinit(&acfs);
+    acfs_destroy_storage_device(&storage);
+    printf("✓ 过期数据测试通过\n");
+}
+
+void test_cache_mode()
+{
+    printf("测试: 缓存模式\n");
+    
+    // 24个数据簇
+    storage_device_t storage;
+    acfs_create_eeprom_device(&storage, 0x0000, 4 * 1024);
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 8,
+        .format_if_invalid = true,
+        .enable_crc_check = true
+    };
+    
+    // 普通卷空间不足时报错
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    char data[400];
+    memset(data, 0x3C, sizeof(data));
+    char name[16];
+    for (int i = 0; i < 12; i++) {
+        sprintf(name, "k%d", i);
+        assert(acfs_write(&acfs, name, data, 200) == ACFS_OK);
+    }
+    assert(acfs_write(&acfs, "k12", data, 200) == ACFS_ERROR_NO_SPACE);
+    acfs_deinit(&acfs);
+    
+    // 缓存模式在格式化时启用
+    config.cache_mode = true;
+    acfs_destroy_storage_device(&storage);
+    acfs_create_eeprom_device(&storage, 0x0000, 4 * 1024);
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    
+    for (int i = 0; i < 12; i++) {
+        sprintf(name, "k%d", i);
+        assert(acfs_write(&acfs, name, data, 200) == ACFS_OK);
+    }
+    
+    // 全部刚写入时淘汰最早写入的
+    assert(acfs_write(&acfs, "k12", data, 200) == ACFS_OK);
+    assert(!acfs_exists(&acfs, "k0"));
+    
+    // 读取过的和刚写入的数据获得第二次机会，淘汰之后未访问的
+    char buffer[400];
+    size_t actual_size;
+    assert(acfs_read(&acfs, "k1", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(acfs_write(&acfs, "k13", data, 200) == ACFS_OK);
+    assert(acfs_exists(&acfs, "k1") && acfs_exists(&acfs, "k12"));
+    assert(!acfs_exists(&acfs, "k2"));
+    
+    // 一次写入可淘汰多个条目
+    assert(acfs_write(&acfs, "big", data, 400) == ACFS_OK);
+    int evicted = 0;
+    for (int i = 3; i < 12; i++) {
+        sprintf(name, "k%d", i);
+        evicted += !acfs_exists(&acfs, name);
+    }
+    assert(evicted == 2);
+    assert(acfs_exists(&acfs, "k12") && acfs_exists(&acfs, "k13"));
+    
+    // 超过卷容量的数据不淘汰任何条目
+    uint16_t before, after;
+    acfs_get_stats(&acfs, NULL, NULL, NULL, &before);
+    static char huge[24 * 128 + 1];
+    assert(acfs_write(&acfs, "huge", huge, sizeof(huge)) == ACFS_ERROR_NO_SPACE);
+    acfs_get_stats(&acfs, NULL, NULL, NULL, &after);
+    assert(before == after);
+    
+    // 缓存模式随卷持久化，淘汰结果已提交
+    acfs_deinit(&acfs);
+    config.cache_mode = false;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    assert(!acfs_exists(&acfs, "k2"));
+    assert(acfs_read(&acfs, "big", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(actual_size == 400);
+    assert(acfs_write(&acfs, "k14", data, 200) == ACFS_OK);
+    acfs_deinit(&acfs);
+    
+    // 计数器和队列的操作同样置位访问标记，持续使用的不被淘汰
+    config.cache_mode = true;
+    config.value_cache_size = 512;
+    acfs_destroy_storage_device(&storage);
+    acfs_create_eeprom_device(&storage, 0x0000, 4 * 1024);
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    // 先写满一轮，淘汰扫描清除这些刚写入数据的访问标记
+    for (int i = 0; i < 13; i++) {
+        sprintf(name, "f%d", i);
+        assert(acfs_write(&acfs, name, data, 200) == ACFS_OK);
+    }
+    assert(acfs_counter_create(&acfs, "hits", 0) == ACFS_OK);
+    assert(acfs_queue_create(&acfs, "events") == ACFS_OK);
+    for (int i = 0; i < 30; i++) {
+        sprintf(name, "v%d", i);
+        assert(acfs_counter_add(&acfs, "hits", 1, NULL) == ACFS_OK);
+        assert(acfs_queue_push(&acfs, "events", &i, sizeof(i)) == ACFS_OK);
+        assert(acfs_write(&acfs, name, data, 200) == ACFS_OK);
+        int event = -1;
+        assert(acfs_queue_pop(&acfs, "events", &event, sizeof(event), NULL) == ACFS_OK && event == i);
+    }
+    assert(!acfs_exists(&acfs, "v0"));
+    uint64_t hits;
+    assert(acfs_counter_get(&acfs, "hits", &hits) == ACFS_OK && hits == 30);
+    
+    // 固定在值缓存中的数据不被淘汰
+    assert(acfs_pin(&acfs, "v29") == ACFS_OK);
+    for (int i = 0; i < 30; i++) {
+        sprintf(name, "w%d", i);
+        assert(acfs_write(&acfs, name, data, 200) == ACFS_OK);
+    }
+    assert(acfs_exists(&acfs, "v29"));
+    assert(acfs_unpin(&acfs, "v29") == ACFS_OK);
+    for (int i = 0; i < 30; i++) {
+        sprintf(name, "u%d", i);
+        assert(acfs_write(&acfs, name, data, 200) == ACFS_OK);
+    }
+    assert(!acfs_exists(&acfs, "v29"));
+    
+    // 导入到缓存模式的卷时同样按需淘汰，同名的计数器被普通数据取代
+    static test_stream_t stream;
+    memset(&stream, 0, sizeof(stream));
+    assert(acfs_export(&acfs, stream_write, &stream) == ACFS_OK);
+    acfs_deinit(&acfs);
+    acfs_destroy_storage_device(&storage);
+    acfs_create_eeprom_device(&storage, 0x0000, 4 * 1024);
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    assert(acfs_counter_create(&acfs, "u29", 7) == ACFS_OK);
+    for (int i = 0; i < 12; i++) {
+        sprintf(name, "k%d", i);
+        assert(acfs_write(&acfs, name, data, 200) == ACFS_OK);
+    }
+    assert(acfs_import(&acfs, stream_read, &stream) == ACFS_OK);
+    assert(acfs_read(&acfs, "u29", buffer, sizeof(buffer), &actual_size) == ACFS_OK && actual_size == 200);
+    assert(acfs_counter_get(&acfs, "u29", &hits) == ACFS_ERROR_INVALID_PARAM);
+    assert(!acfs_exists(&acfs, "k0"));
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    
+    acfs_deinit(&acfs);
+    acfs_destroy_storage_device(&storage);
+    printf("✓ 缓存模式测试通过\n");
+}
+
+void test_value_cache()
+{
+    printf("测试: 值缓存\n");
+    
+    storage_device_t storage;
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 8,
+        .format_if_invalid = true,
+        .enable_crc_check = true
+    };
+    
+    // 未启用值缓存时不能固定
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    assert(acfs_write(&acfs, "hot", "hot value", 10) == ACFS_OK);
+    assert(acfs_pin(&acfs, "hot") == ACFS_ERROR_INVALID_PARAM);
+    acfs_deinit(&acfs);
+    
+    config.value_cache_size = 512;
+    config.value_cache_max_value = 64;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    
+    // 小数据读取后常驻缓存，再次读取不访问存储
+    char buffer[300];
+    size_t actual_size;
+    assert(acfs_read(&acfs, "hot", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    corrupt_first_cluster(&acfs, &storage, "hot");
+    assert(acfs_read(&acfs, "hot", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(actual_size == 10 && strcmp(buffer, "hot value") == 0);
+    
+    // 写入后缓存失效
+    assert(acfs_write(&acfs, "hot", "new value", 10) == ACFS_OK);
+    assert(acfs_read(&acfs, "hot", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(strcmp(buffer, "new value") == 0);
+    
+    // 超过自动缓存上限的数据不缓存
+    char large[200];
+    memset(large, 0x42, sizeof(large));
+    assert(acfs_write(&acfs, "large", large, sizeof(large)) == ACFS_OK);
+    assert(acfs_read(&acfs, "large", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    corrupt_first_cluster(&acfs, &storage, "large");
+    assert(acfs_read(&acfs, "large", buffer, sizeof(buffer), &actual_size) == ACFS_ERROR_CRC_MISMATCH);
+    
+    // 固定的数据不受大小上限限制，覆盖写入后缓存随之更新
+    assert(acfs_write(&acfs, "large", large, sizeof(large)) == ACFS_OK);
+    assert(acfs_pin(&acfs, "large") == ACFS_OK);
+    large[0] = 0x43;
+    assert(acfs_write(&acfs, "large", large, sizeof(large)) == ACFS_OK);
+    corrupt_first_cluster(&acfs, &storage, "large");
+    assert(acfs_read(&acfs, "large", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(memcmp(buffer, large, sizeof(large)) == 0);
+    
+    // 改名后固定随条目转移
+    assert(acfs_rename(&acfs, "large", "renamed", false) == ACFS_OK);
+    assert(acfs_read(&acfs, "renamed", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(memcmp(buffer, large, sizeof(large)) == 0);
+    
+    // 取消固定后可被其他固定的数据换出
+    assert(acfs_unpin(&acfs, "renamed") == ACFS_OK);
+    assert(acfs_write(&acfs, "other", large, sizeof(large)) == ACFS_OK);
+    assert(acfs_pin(&acfs, "other") == ACFS_OK);
+    assert(acfs_write(&acfs, "third", large, sizeof(large)) == ACFS_OK);
+    assert(acfs_pin(&acfs, "third") == ACFS_OK);
+    assert(acfs_read(&acfs, "renamed", buffer, sizeof(buffer), &actual_size) == ACFS_ERROR_CRC_MISMATCH);
+    
+    // 固定的数据占满缓存后不能再固定
+    assert(acfs_write(&acfs, "fourth", large, sizeof(large)) == ACFS_OK);
+    assert(acfs_pin(&acfs, "fourth") == ACFS_ERROR_NO_SPACE);
+    
+    // 删除后固定失效
+    assert(acfs_delete(&acfs, "other") == ACFS_OK);
+    assert(acfs_pin(&acfs, "other") == ACFS_ERROR_DATA_NOT_FOUND);
+    assert(acfs_pin(&acfs, "fourth") == ACFS_OK);
+    
+    // 新值放不进缓存时固定保留，之后的读取从存储读；新值变小后重新缓存
+    char big[400];
+    acfs_stat_t info;
+    memset(big, 0x44, sizeof(big));
+    assert(acfs_write(&acfs, "third", big, sizeof(big)) == ACFS_OK);
+    assert(acfs_stat(&acfs, "third", &info) == ACFS_OK && info.pinned);
+    assert(acfs_read(&acfs, "third", big, sizeof(big), &actual_size) == ACFS_OK);
+    assert(actual_size == sizeof(big) && big[399] == 0x44);
+    assert(acfs_stat(&acfs, "third", &info) == ACFS_OK && info.pinned);
+    assert(acfs_write(&acfs, "third", "small", 6) == ACFS_OK);
+    corrupt_first_cluster(&acfs, &storage, "third");
+    assert(acfs_read(&acfs, "third", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(strcmp(buffer, "small") == 0);
+    
+    acfs_deinit(&acfs);
+    acfs_destroy_storage_device(&storage);
+    printf("✓ 值缓存测试通过\n");
+}
+
+void test_writev()
+{
+    printf("测试: 分散写入\n");
+    
+    storage_device_t storage;
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 8,
+        .format_if_invalid = true,
+        .enable_crc_check = true,
+        .enable_cluster_trailer = true
+    };
+    
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    
+    // 头部、载荷和尾部跨越簇边界，中间夹一个空段
+    struct { uint32_t magic; uint16_t length; } head = { 0x12345678, 300 };
+    uint8_t payload[300];
+    for (int i = 0; i < (int)sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 7);
+    }
+    uint32_t tail = 0xCAFEBABE;
+    acfs_iovec_t iov[4] = {
+        { &head, sizeof(head) },
+        { NULL, 0 },
+        { payload, sizeof(payload) },
+        { &tail, sizeof(tail) }
+    };
+    assert(acfs_writev(&acfs, "record", iov, 4) == ACFS_OK);
+    
+    uint8_t expected[sizeof(head) + sizeof(payload) + sizeof(tail)];
+    memcpy(expected, &head, sizeof(head));
+    memcpy(expected + sizeof(head), payload, sizeof(payload));
+    memcpy(expected + sizeof(head) + sizeof(payload), &tail, sizeof(tail));
+    
+    uint8_t buffer[sizeof(expected)];
+    size_t actual_size;
+    assert(acfs_read(&acfs, "record", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(actual_size == sizeof(expected));
+    assert(memcmp(buffer, expected, sizeof(expected)) == 0);
+    
+    // 与连续写入的结果一致
+    uint32_t crc = acfs.entries[0].crc32;
+    assert(acfs_write(&acfs, "record", expected, sizeof(expected)) == ACFS_OK);
+    assert(acfs.entries[0].crc32 == crc);
+    
+    // 空数据和缺少数据的段无效
+    assert(acfs_writev(&acfs, "empty", iov + 1, 1) == ACFS_ERROR_INVALID_PARAM);
+    acfs_iovec_t bad = { NULL, 4 };
+    assert(acfs_writev(&acfs, "bad", &bad, 1) == ACFS_ERROR_INVALID_PARAM);
+    assert(acfs_writev(&acfs, "bad", NULL, 0) == ACFS_ERROR_INVALID_PARAM);
+    
+    acfs_deinit(&acfs);
+    acfs_destroy_storage_device(&storage);
+    printf("✓ 分散写入测试通过\n");
+}
+
+static const acfs_data_entry_t* entry_by_name(const acfs_t* acfs, const char* data_id)
+{
+    for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
+        if (acfs->entries[i].is_valid && strcmp(acfs->entries[i].data_id, data_id) == 0) {
+            return &acfs->entries[i];
+        }
+    }
+    return NULL;
+}
+
+/* 统计设备写入次数 */
+static int (*counted_write_next)(uint32_t addr, const void* data, size_t size);
+static int counted_writes;
+
+static int counted_write(uint32_t addr, const void* data, size_t size)
+{
+    counted_writes++;
+    return counted_write_next(addr, data, size);
+}
+
+void test_ring()
+{
+    printf("测试: 环形记录\n");
+    
+    storage_device_t storage;
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    counted_write_next = storage.ops.write;
+    storage.ops.write = counted_write;
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 8,
+        .format_if_invalid = true,
+        .enable_crc_check = true
+    };
+    
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    
+    // 每簇5条记录，10条记录占2个记录簇
+    typedef struct { uint32_t index; uint32_t value[2]; } sample_t;
+    assert(acfs_ring_create(&acfs, "samples", sizeof(sample_t), 10) == ACFS_OK);
+    assert(acfs_ring_create(&acfs, "samples", sizeof(sample_t), 10) == ACFS_ERROR_DATA_EXISTS);
+    assert(acfs_ring_create(&acfs, "huge", 200, 10) == ACFS_ERROR_INVALID_PARAM);
+    
+    char buffer[512];
+    size_t actual_size;
+    assert(acfs_read(&acfs, "samples", buffer, sizeof(buffer), &actual_size) == ACFS_ERROR_INVALID_PARAM);
+    
+    sample_t out[10];
+    uint32_t count;
+    assert(acfs_ring_read_range(&acfs, "samples", out, 10, &count) == ACFS_OK && count == 0);
+    
+    // 每条记录只写一次设备
+    for (uint32_t i = 1; i <= 4; i++) {
+        sample_t sample = { i, { i * 10, i * 100 } };
+        counted_writes = 0;
+        assert(acfs_ring_push(&acfs, "samples", &sample) == ACFS_OK);
+        assert(counted_writes == 1);
+    }
+    assert(acfs_ring_read_range(&acfs, "samples", out, 10, &count) == ACFS_OK && count == 4);
+    for (uint32_t i = 0; i < 4; i++) {
+        assert(out[i].index == i + 1 && out[i].value[1] == (i + 1) * 100);
+    }
+    
+    // 写满后覆盖最旧的记录
+    for (uint32_t i = 5; i <= 13; i++) {
+        sample_t sample = { i, { i * 10, i * 100 } };
+        assert(acfs_ring_push(&acfs, "samples", &sample) == ACFS_OK);
+    }
+    assert(acfs_ring_read_range(&acfs, "samples", out, 10, &count) == ACFS_OK && count == 10);
+    assert(out[0].index == 4 && out[9].index == 13);
+    assert(acfs_ring_read_range(&acfs, "samples", out, 3, &count) == ACFS_OK && count == 3);
+    assert(out[0].index == 11 && out[2].index == 13);
+    
+    // 重新挂载后扫描出写入位置
+    acfs_deinit(&acfs);
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    sample_t sample = { 14, { 140, 1400 } };
+    assert(acfs_ring_push(&acfs, "samples", &sample) == ACFS_OK);
+    assert(acfs_ring_read_range(&acfs, "samples", out, 2, &count) == ACFS_OK && count == 2);
+    assert(out[0].index == 13 && out[1].index == 14);
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    
+    // 序号越过32位后仍连续，重新挂载后能找到写入位置
+    assert(acfs_ring_create(&acfs, "wide", sizeof(sample_t), 7) == ACFS_OK);
+    assert(acfs_ring_read_range(&acfs, "wide", out, 0, &count) == ACFS_OK);
+    uint32_t wide_hash = entry_by_name(&acfs, "wide")->owner_hash;
+    for (int i = 0; i < ACFS_RING_CURSORS; i++) {
+        if (acfs.ring_cursor[i].owner_hash == wide_hash) {
+            acfs.ring_cursor[i].next_seq = ((0xFFFFFFFFull - 3) / 7) * 7 + 1;
+        }
+    }
+    for (uint32_t i = 1; i <= 20; i++) {
+        sample_t wide = { i, { 0, 0 } };
+        assert(acfs_ring_push(&acfs, "wide", &wide) == ACFS_OK);
+    }
+    assert(acfs_ring_read_range(&acfs, "wide", out, 10, &count) == ACFS_OK && count == 7);
+    assert(out[0].index == 14 && out[6].index == 20);
+    acfs_deinit(&acfs);
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    sample_t wide = { 21, { 0, 0 } };
+    assert(acfs_ring_push(&acfs, "wide", &wide) == ACFS_OK);
+    assert(acfs_ring_read_range(&acfs, "wide", out, 10, &count) == ACFS_OK && count == 7);
+    assert(out[0].index == 15 && out[6].index == 21);
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    assert(acfs_delete(&acfs, "wide") == ACFS_OK);
+    
+    // 快照期间的写入先复制簇，回滚后恢复快照时的内容
+    assert(acfs_snapshot_create(&acfs) == ACFS_OK);
+    sample.index = 15;
+    assert(acfs_ring_push(&acfs, "samples", &sample) == ACFS_OK);
+    assert(acfs_ring_read_range(&acfs, "samples", out, 1, &count) == ACFS_OK && out[0].index == 15);
+    assert(acfs_snapshot_restore(&acfs) == ACFS_OK);
+    assert(acfs_ring_read_range(&acfs, "samples", out, 1, &count) == ACFS_OK && out[0].index == 14);
+    assert(acfs_snapshot_delete(&acfs) == ACFS_OK);
+    
+    // 普通数据不能作为环形记录写入
+    assert(acfs_write(&acfs, "plain", "value", 6) == ACFS_OK);
+    assert(acfs_ring_push(&acfs, "plain", &sample) == ACFS_ERROR_INVALID_PARAM);
+    
+    acfs_deinit(&acfs);
+    acfs_destroy_storage_device(&storage);
+    printf("✓ 环形记录测试通过\n");
+}
+
+typedef struct {
+    uint32_t received[16];
+    uint32_t count;
+    uint32_t limit;
+} queue_sink_t;
+
+static acfs_error_t queue_collect(const void* data, size_t size, void* user_data)
+{
+    queue_sink_t* sink = (queue_sink_t*)user_data;
+    if (sink->count == sink->limit) {
+        return ACFS_ERROR_BUSY;
+    }
+    assert(size == 40);
+    memcpy(&sink->received[sink->count++], data, sizeof(uint32_t));
+    return ACFS_OK;
+}
+
+void test_queue()
+{
+    printf("测试: 队列\n");
+    
+    storage_device_t storage;
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    counted_write_next = storage.ops.write;
+    storage.ops.write = counted_write;
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 8,
+        .format_if_invalid = true,
+        .enable_crc_check = true
+    };
+    
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    
+    size_t total, used, free_before, free_after;
+    uint16_t entries;
+    assert(acfs_queue_create(&acfs, "jobs") == ACFS_OK);
+    assert(acfs_queue_create(&acfs, "jobs") == ACFS_ERROR_DATA_EXISTS);
+    assert(acfs_get_stats(&acfs, &total, &used, &free_before, &entries) == ACFS_OK);
+    
+    uint8_t message[128];
+    size_t actual_size;
+    uint32_t length;
+    assert(acfs_queue_push(&acfs, "jobs", message, 121) == ACFS_ERROR_INVALID_PARAM);
+    assert(acfs_queue_pop(&acfs, "jobs", message, sizeof(message), &actual_size) == ACFS_ERROR_QUEUE_EMPTY);
+    assert(acfs_read(&acfs, "jobs", message, sizeof(message), &actual_size) == ACFS_ERROR_INVALID_PARAM);
+    
+    // 每簇放2条40字节的消息，不跨簇时写入消息和队列头各一次
+    for (uint32_t i = 0; i < 10; i++) {
+        memset(message, (int)i, 40);
+        memcpy(message, &i, sizeof(i));
+        counted_writes = 0;
+        assert(acfs_queue_push(&acfs, "jobs", message, 40) == ACFS_OK);
+        if (i == 0 || i == 1) {
+            assert(counted_writes == 2);
+        }
+    }
+    assert(acfs_queue_length(&acfs, "jobs", &length) == ACFS_OK && length == 10);
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    
+    // 缓冲区不足时不出队
+    assert(acfs_queue_pop(&acfs, "jobs", message, 16, &actual_size) == ACFS_ERROR_INVALID_PARAM);
+    assert(actual_size == 40);
+    assert(acfs_queue_length(&acfs, "jobs", &length) == ACFS_OK && length == 10);
+    
+    for (uint32_t i = 0; i < 3; i++) {
+        uint32_t value;
+        assert(acfs_queue_pop(&acfs, "jobs", message, sizeof(message), &actual_size) == ACFS_OK);
+        memcpy(&value, message, sizeof(value));
+        assert(actual_size == 40 && value == i && message[39] == i);
+    }
+    
+    // 重新挂载后从持久化的队列头继续
+    acfs_deinit(&acfs);
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    assert(acfs_queue_length(&acfs, "jobs", &length) == ACFS_OK && length == 7);
+    
+    // 回调返回错误时停止，该消息保留在队列中
+    queue_sink_t sink = { .count = 0, .limit = 3 };
+    uint32_t popped;
+    assert(acfs_queue_pop_batch(&acfs, "jobs", 0, queue_collect, &sink, &popped) == ACFS_ERROR_BUSY);
+    assert(popped == 3 && sink.received[0] == 3 && sink.received[2] == 5);
+    sink.limit = 16;
+    assert(acfs_queue_pop_batch(&acfs, "jobs", 2, queue_collect, &sink, &popped) == ACFS_OK && popped == 2);
+    assert(acfs_queue_pop_batch(&acfs, "jobs", 0, queue_collect, &sink, &popped) == ACFS_OK && popped == 2);
+    assert(sink.count == 7 && sink.received[6] == 9);
+    assert(acfs_queue_pop(&acfs, "jobs", message, sizeof(message), &actual_size) == ACFS_ERROR_QUEUE_EMPTY);
+    
+    // 读完的簇已回收
+    assert(acfs_get_stats(&acfs, &total, &used, &free_after, &entries) == ACFS_OK);
+    assert(free_after == free_before);
+    
+    // 快照回滚恢复出队前的状态
+    assert(acfs_queue_push(&acfs, "jobs", message, 40) == ACFS_OK);
+    assert(acfs_snapshot_create(&acfs) == ACFS_OK);
+    assert(acfs_queue_pop(&acfs, "jobs", message, sizeof(message), &actual_size) == ACFS_OK);
+    assert(acfs_snapshot_restore(&acfs) == ACFS_OK);
+    assert(acfs_queue_length(&acfs, "jobs", &length) == ACFS_OK && length == 1);
+    assert(acfs_snapshot_delete(&acfs) == ACFS_OK);
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    
+    acfs_deinit(&acfs);
+    acfs_destroy_storage_device(&storage);
+    printf("✓ 队列测试通过\n");
+}
+
+void test_counter()
+{
+    printf("测试: 计数器\n");
+    
+    storage_device_t storage;
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    counted_write_next = storage.ops.write;
+    storage.ops.write = counted_write;
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 8,
+        .format_if_invalid = true,
+        .enable_crc_check = true
+    };
+    
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    
+    uint64_t value;
+    assert(acfs_counter_create(&acfs, "boots", 1000) == ACFS_OK);
+    assert(acfs_counter_create(&acfs, "boots", 0) == ACFS_ERROR_DATA_EXISTS);
+    assert(acfs_counter_get(&acfs, "boots", &value) == ACFS_OK && value == 1000);
+    
+    // 每次累加只写一条日志，不改写元数据；日志写满（每簇10条）时压缩
+    uint32_t sequence, sequence_after;
+    assert(acfs_get_sequence(&acfs, &sequence) == ACFS_OK);
+    for (uint32_t i = 1; i <= 25; i++) {
+        counted_writes = 0;
+        assert(acfs_counter_add(&acfs, "boots", i, &value) == ACFS_OK);
+        assert(counted_writes == (i % 11 == 0 ? 2 : 1));
+    }
+    assert(value == 1000 + 25 * 26 / 2);
+    assert(acfs_get_sequence(&acfs, &sequence_after) == ACFS_OK && sequence_after == sequence);
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    
+    // 模拟压缩时基值写完、日志区未清空即掉电：当前第3代的3条日志不再重复累加
+    acfs_counter_base_t base = { ACFS_COUNTER_MAGIC, 4, 1325, 0 };
+    base.crc32 = acfs_crc32(&base, sizeof(base) - sizeof(uint32_t));
+    uint32_t addr = storage.start_addr + acfs.entries[0].cluster_list[0] * config.cluster_size;
+    assert(storage.ops.write(addr + (4 % 2) * ACFS_COUNTER_BASE_SLOT, &base, sizeof(base)) == 0);
+    assert(acfs_counter_get(&acfs, "boots", &value) == ACFS_OK && value == 1325);
+    assert(acfs_counter_add(&acfs, "boots", 5, &value) == ACFS_OK && value == 1330);
+    
+    // 重新挂载后读取
+    acfs_deinit(&acfs);
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    assert(acfs_counter_get(&acfs, "boots", &value) == ACFS_OK && value == 1330);
+    
+    char buffer[128];
+    size_t actual_size;
+    assert(acfs_read(&acfs, "boots", buffer, sizeof(buffer), &actual_size) == ACFS_ERROR_INVALID_PARAM);
+    assert(acfs_write(&acfs, "plain", "value", 6) == ACFS_OK);
+    assert(acfs_counter_add(&acfs, "plain", 1, NULL) == ACFS_ERROR_INVALID_PARAM);
+    assert(acfs_counter_get(&acfs, "missing", &value) == ACFS_ERROR_DATA_NOT_FOUND);
+    
+    acfs_deinit(&acfs);
+    acfs_destroy_storage_device(&storage);
+    printf("✓ 计数器测试通过\n");
+}
+
+/* 统计设备读取次数 */
+static int (*counted_read_next)(uint32_t addr, void* data, size_t size);
+static int counted_reads;
+
+static int counted_read(uint32_t addr, void* data, size_t size)
+{
+    counted_reads++;
+    return counted_read_next(addr, data, size);
+}
+
+void test_stat()
+{
+    printf("测试: 条目元数据\n");
+    
+    storage_device_t storage;
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    counted_read_next = storage.ops.read;
+    storage.ops.read = counted_read;
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 8,
+        .format_if_invalid = true,
+        .enable_crc_check = true,
+        .value_cache_size = 1024
+    };
+    
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    
+    char data[300];
+    memset(data, 0x5A, sizeof(data));
+    uint32_t version;
+    assert(acfs_write_if_version(&acfs, "config", 0, data, sizeof(data), &version) == ACFS_OK);
+    assert(acfs_write(&acfs, "small", "value", 6) == ACFS_OK);
+    assert(acfs_pin(&acfs, "small") == ACFS_OK);
+    
+    // 只读取内存中的条目，不访问设备
+    acfs_stat_t info;
+    counted_reads = 0;
+    assert(acfs_stat(&acfs, "config", &info) == ACFS_OK);
+    assert(counted_reads == 0);
+    assert(info.size == sizeof(data) && info.crc32 == acfs_crc32(data, sizeof(data)));
+    assert(info.version == version && info.cluster_count == 3 && info.extent_count == 1);
+    assert(info.type == ACFS_TYPE_VALUE && !info.pinned && info.expire_at == 0);
+    assert(acfs_stat(&acfs, "missing", &info) == ACFS_ERROR_DATA_NOT_FOUND);
+    
+    // 版本号可直接用于按版本写入
+    assert(acfs_write_if_version(&acfs, "config", info.version, data, 10, NULL) == ACFS_OK);
+    
+    const char* ids[] = { "small", "missing", "config" };
+    acfs_stat_t infos[3];
+    acfs_error_t results[3];
+    uint16_t found;
+    counted_reads = 0;
+    assert(acfs_stat_batch(&acfs, ids, 3, infos, results, &found) == ACFS_OK);
+    assert(counted_reads == 0 && found == 2);
+    assert(results[0] == ACFS_OK && infos[0].size == 6 && infos[0].pinned);
+    assert(results[1] == ACFS_ERROR_DATA_NOT_FOUND && infos[1].size == 0);
+    assert(results[2] == ACFS_OK && infos[2].size == 10 && infos[2].version != version);
+    
+    acfs_deinit(&acfs);
+    acfs_destroy_storage_device(&storage);
+    printf("✓ 条目元数据测试通过\n");
+}
+
+void test_resize()
+{
+    printf("测试: 调整大小\n");
+    
+    storage_device_t storage;
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    counted_write_next = storage.ops.write;
+    storage.ops.write = counted_write;
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 8,
+        .format_if_invalid = true,
+        .enable_crc_check = true
+    };
+    
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    
+    uint8_t data[600];
+    uint8_t buffer[600];
+    size_t actual_size;
+    memset(data, 0xA5, sizeof(data));
+    assert(acfs_write(&acfs, "log", data, 300) == ACFS_OK);
+    uint16_t prefix[3];
+    memcpy(prefix, acfs.entries[0].cluster_list, sizeof(prefix));
+    
+    // 簇数不变时只提交元数据，增长部分补零
+    counted_writes = 0;
+    assert(acfs_resize(&acfs, "log", 310) == ACFS_OK);
+    int commit_writes = counted_writes;
+    assert(acfs_read(&acfs, "log", buffer, sizeof(buffer), &actual_size) == ACFS_OK && actual_size == 310);
+    assert(buffer[299] == 0xA5 && buffer[300] == 0 && buffer[309] == 0);
+    
+    // 增长一簇只多写入新簇
+    counted_writes = 0;
+    assert(acfs_resize(&acfs, "log", 500) == ACFS_OK);
+    assert(counted_writes == commit_writes + 1);
+    assert(memcmp(acfs.entries[0].cluster_list, prefix, sizeof(prefix)) == 0);
+    
+    // 截短释放尾部的簇并清零新末簇的剩余部分，再增长时读到零
+    size_t free_before, free_after;
+    acfs_get_free_space(&acfs, &free_before);
+    assert(acfs_truncate(&acfs, "log", 200) == ACFS_OK);
+    acfs_get_free_space(&acfs, &free_after);
+    assert(free_after == free_before + 2 * 128);
+    assert(acfs_resize(&acfs, "log", 260) == ACFS_OK);
+    assert(acfs_read(&acfs, "log", buffer, sizeof(buffer), &actual_size) == ACFS_OK && actual_size == 260);
+    assert(buffer[199] == 0xA5 && buffer[200] == 0 && buffer[259] == 0);
+    assert(memcmp(acfs.entries[0].cluster_list, prefix, sizeof(prefix)) == 0);
+    
+    assert(acfs_truncate(&acfs, "log", 300) == ACFS_ERROR_INVALID_PARAM);
+    assert(acfs_resize(&acfs, "log", 0) == ACFS_ERROR_INVALID_PARAM);
+    assert(acfs_resize(&acfs, "missing", 10) == ACFS_ERROR_DATA_NOT_FOUND);
+    
+    // 截短前校验旧值，损坏的数据不会截短成CRC正确的值
+    assert(acfs_write(&acfs, "bad", data, 300) == ACFS_OK);
+    corrupt_first_cluster(&acfs, &storage, "bad");
+    assert(acfs_truncate(&acfs, "bad", 100) == ACFS_ERROR_CRC_MISMATCH);
+    assert(acfs_read(&acfs, "bad", buffer, sizeof(buffer), &actual_size) == ACFS_ERROR_CRC_MISMATCH);
+    assert(acfs_delete(&acfs, "bad") == ACFS_OK);
+    
+    // 覆盖写入改变簇数时同样保留共同前缀
+    memset(data, 0x3C, sizeof(data));
+    assert(acfs_write(&acfs, "log", data, sizeof(data)) == ACFS_OK);
+    assert(acfs.entries[0].cluster_count == 5);
+    assert(memcmp(acfs.entries[0].cluster_list, prefix, sizeof(prefix)) == 0);
+    assert(acfs_read(&acfs, "log", buffer, sizeof(buffer), &actual_size) == ACFS_OK);
+    assert(memcmp(buffer, data, sizeof(data)) == 0);
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    
+    acfs_deinit(&acfs);
+    acfs_destroy_storage_device(&storage);
+    
+    // 簇尾部：改写新末簇的尾部，元数据重建后大小和内容正确
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    config.enable_cluster_trailer = true;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    assert(acfs_write(&acfs, "log", data, 300) == ACFS_OK);
+    assert(acfs_truncate(&acfs, "log", 150) == ACFS_OK);
+    assert(acfs_resize(&acfs, "log", 260) == ACFS_OK);
+    acfs_deinit(&acfs);
+    
+    assert(acfs_fsck(&storage, &config, NULL) == ACFS_OK);
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    assert(acfs_read(&acfs, "log", buffer, sizeof(buffer), &actual_size) == ACFS_OK && actual_size == 260);
+    assert(buffer[149] == 0x3C && buffer[150] == 0 && buffer[259] == 0);
+    
+    acfs_deinit(&acfs);
+    acfs_destroy_storage_device(&storage);
+    printf("✓ 调整大小测试通过\n");
+}
+
+void test_reserve()
+{
+    printf("测试: 空间预留\n");
+    
+    storage_device_t storage;
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 8,
+        .format_if_invalid = true,
+        .enable_crc_check = true
+    };
+    
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    
+    // 制造一个单簇空洞
+    uint8_t data[1280];
+    memset(data, 0x77, sizeof(data));
+    assert(acfs_write(&acfs, "a", data, 100) == ACFS_OK);
+    assert(acfs_write(&acfs, "b", data, 100) == ACFS_OK);
+    assert(acfs_write(&acfs, "c", data, 100) == ACFS_OK);
+    assert(acfs_delete(&acfs, "b") == ACFS_OK);
+    
+    size_t free_before, free_after;
+    acfs_get_free_space(&acfs, &free_before);
+    assert(acfs_reserve(&acfs, "stream", sizeof(data)) == ACFS_OK);
+    acfs_get_free_space(&acfs, &free_after);
+    assert(free_after == free_before - 10 * 128);
+    
+    // 分块增长的数据落在预留的连续簇上，其他数据不占用预留
+    assert(acfs_write(&acfs, "stream", data, 100) == ACFS_OK);
+    assert(acfs_write(&acfs, "other", data, 100) == ACFS_OK);
+    for (size_t size = 228; size <= sizeof(data); size += 128) {
+        assert(acfs_resize(&acfs, "stream", size) == ACFS_OK);
+    }
+    acfs_data_entry_t* stream = &acfs.entries[3];
+    assert(strcmp(stream->data_id, "stream") == 0 && stream->cluster_count == 10);
+    for (uint16_t i = 1; i < stream->cluster_count; i++) {
+        assert(stream->cluster_list[i] == stream->cluster_list[0] + i);
+    }
+    acfs_get_free_space(&acfs, &free_after);
+    assert(free_after == free_before - 11 * 128);
+    assert(acfs_release_reservation(&acfs, "stream") == ACFS_ERROR_DATA_NOT_FOUND);
+    
+    // 归还未使用的部分
+    assert(acfs_reserve(&acfs, "big", 20 * 128) == ACFS_OK);
+    assert(acfs_write(&acfs, "big", data, 300) == ACFS_OK);
+    assert(acfs_release_reservation(&acfs, "big") == ACFS_OK);
+    acfs_get_free_space(&acfs, &free_after);
+    assert(free_after == free_before - 14 * 128);
+    
+    assert(acfs_reserve(&acfs, "huge", 1024 * 128) == ACFS_ERROR_NO_SPACE);
+    assert(acfs_reserve(&acfs, "stream", 128) == ACFS_OK);
+    
+    // 预留不持久化，重新挂载后归还
+    assert(acfs_reserve(&acfs, "tmp", 5 * 128) == ACFS_OK);
+    acfs_deinit(&acfs);
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    acfs_get_free_space(&acfs, &free_after);
+    assert(free_after == free_before - 14 * 128);
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    
+    acfs_deinit(&acfs);
+    acfs_destroy_storage_device(&storage);
+    printf("✓ 空间预留测试通过\n");
+}
+
+/* 空闲段索引与位图一致：每个最长空闲簇段恰好在其大小级别的链表中出现一次 */
+static void check_extent_index(const acfs_t* acfs)
+{
+    const acfs_extent_index_t* index = (const acfs_extent_index_t*)acfs->allocator_state;
+    assert(acfs->allocator == &acfs_allocator_extent && index);
+    
+    uint16_t listed = 0;
+    for (uint8_t c = 0; c < ACFS_EXTENT_CLASSES; c++) {
+        for (uint16_t s = index->head[c]; s != ACFS_EXTENT_NONE; s = index->nodes[s].next) {
+            uint16_t length = index->nodes[s].length;
+            assert(length >= (1u << c) && (c == ACFS_EXTENT_CLASSES - 1 || length < (2u << c)));
+            assert(index->nodes[s + length - 1].start == s);
+            listed += length;
+        }
+    }
+    
+    uint16_t run = 0;
+    for (uint32_t i = acfs->header.sys_clusters; i <= acfs->header.total_clusters; i++) {
+        bool used = (i == acfs->header.total_clusters) || (acfs->cluster_bitmap[i / 8] & (1 << (i % 8)));
+        if (!used) {
+            run++;
+            continue;
+        }
+        if (run > 0) {
+            assert(index->nodes[i - run].length == run);
+            run = 0;
+        }
+    }
+    assert(listed == acfs->header.free_clusters);
+}
+
+void test_extent_index()
+{
+    printf("测试: 空闲段索引\n");
+    
+    storage_device_t storage;
+    acfs_create_eeprom_device(&storage, 0x0000, 64 * 1024);
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 48,
+        .format_if_invalid = true,
+        .enable_crc_check = true
+    };
+    
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    check_extent_index(&acfs);
+    
+    // 单簇数据隔一个删除一个，制造大量单簇空洞
+    uint8_t data[8 * 128];
+    memset(data, 0x6E, sizeof(data));
+    char name[16];
+    for (int i = 0; i < 40; i++) {
+        snprintf(name, sizeof(name), "s%d", i);
+        assert(acfs_write(&acfs, name, data, 100) == ACFS_OK);
+    }
+    for (int i = 0; i < 40; i += 2) {
+        snprintf(name, sizeof(name), "s%d", i);
+        assert(acfs_delete(&acfs, name) == ACFS_OK);
+    }
+    check_extent_index(&acfs);
+    
+    // 多簇数据跳过空洞，连续存放
+    assert(acfs_write(&acfs, "wide", data, 5 * 128) == ACFS_OK);
+    acfs_data_entry_t* wide = NULL;
+    for (uint16_t i = 0; i < acfs.header.data_entries; i++) {
+        if (acfs.entries[i].is_valid && strcmp(acfs.entries[i].data_id, "wide") == 0) {
+            wide = &acfs.entries[i];
+        }
+    }
+    assert(wide && wide->cluster_count == 5);
+    for (uint16_t i = 1; i < wide->cluster_count; i++) {
+        assert(wide->cluster_list[i] == wide->cluster_list[0] + i);
+    }
+    
+    // 随机写入、删除、调整大小，索引始终与位图一致
+    uint32_t seed = 12345;
+    for (int step = 0; step < 400; step++) {
+        seed = seed * 1103515245 + 12345;
+        snprintf(name, sizeof(name), "r%u", (unsigned)((seed >> 16) % 24));
+        size_t size = 1 + (seed >> 8) % sizeof(data);
+        switch ((seed >> 24) % 3) {
+            case 0:
+                acfs_write(&acfs, name, data, size);
+                break;
+            case 1:
+                acfs_delete(&acfs, name);
+                break;
+            default:
+                acfs_resize(&acfs, name, size);
+                break;
+        }
+        if (step % 50 == 0) {
+            assert(acfs_defragment(&acfs) == ACFS_OK);
+        }
+        check_extent_index(&acfs);
+    }
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    
+    // 重新挂载后按位图重建
+    acfs_deinit(&acfs);
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    check_extent_index(&acfs);
+    
+    acfs_deinit(&acfs);
+    acfs_destroy_storage_device(&storage);
+    printf("✓ 空闲段索引测试通过\n");
+}
+
+/* 测试用分配策略：每次从最高地址取一个空闲簇 */
+static acfs_error_t top_down_mount(acfs_t* acfs)
+{
+    (void)acfs;
+    return ACFS_OK;
+}
+
+static void top_down_unmount(acfs_t* acfs)
+{
+    (void)acfs;
+}
+
+static uint16_t top_down_allocate(acfs_t* acfs, uint16_t count, bool contiguous, uint16_t hint, uint16_t* start)
+{
+    (void)hint;
+    if (contiguous && count > 1) {
+        return 0;
+    }
+    for (uint16_t i = acfs->header.total_clusters; i > acfs->header.sys_clusters; i--) {
+        if (!(acfs->cluster_bitmap[(i - 1) / 8] & (1 << ((i - 1) % 8)))) {
+            *start = i - 1;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void top_down_release(acfs_t* acfs, uint16_t start, uint16_t length)
+{
+    (void)acfs;
+    (void)start;
+    (void)length;
+}
+
+static void top_down_stats(const acfs_t* acfs, acfs_alloc_stats_t* stats)
+{
+    stats->free_clusters = acfs->header.free_clusters;
+}
+
+static const acfs_allocator_t top_down_allocator = {
+    .name = "top-down",
+    .mount = top_down_mount,
+    .unmount = top_down_unmount,
+    .allocate = top_down_allocate,
+    .release = top_down_release,
+    .stats = top_down_stats
+};
+
+/* 挂载总是失败的分配策略 */
+static acfs_error_t failing_mount(acfs_t* acfs)
+{
+    (void)acfs;
+    return ACFS_ERROR_NO_SPACE;
+}
+
+static const acfs_allocator_t failing_allocator = {
+    .name = "failing",
+    .mount = failing_mount,
+    .unmount = top_down_unmount,
+    .allocate = top_down_allocate,
+    .release = top_down_release,
+    .stats = top_down_stats
+};
+
+void test_allocator()
+{
+    printf("测试: 分配策略\n");
+    
+    storage_device_t storage;
+    acfs_create_eeprom_device(&storage, 0x0000, 16 * 1024);
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 16,
+        .format_if_invalid = true,
+        .enable_crc_check = true,
+        .allocator = &acfs_allocator_first_fit
+    };
+    
+    uint8_t data[4 * 128];
+    memset(data, 0x3C, sizeof(data));
+    char name[16];
+    
+    // 首个空闲簇：多簇数据依次填入低地址的空洞
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    assert(acfs.allocator == &acfs_allocator_first_fit);
+    for (int i = 0; i < 8; i++) {
+        snprintf(name, sizeof(name), "a%d", i);
+        assert(acfs_write(&acfs, name, data, 100) == ACFS_OK);
+    }
+    assert(acfs_delete(&acfs, "a1") == ACFS_OK);
+    assert(acfs_delete(&acfs, "a3") == ACFS_OK);
+    
+    acfs_alloc_stats_t stats;
+    assert(acfs_get_alloc_stats(&acfs, &stats) == ACFS_OK);
+    assert(stats.free_clusters == acfs.header.free_clusters);
+    assert(stats.free_extents == 3);
+    assert(stats.largest_extent == acfs.header.free_clusters - 2);
+    
+    assert(acfs_write(&acfs, "wide", data, 3 * 128) == ACFS_OK);
+    const acfs_data_entry_t* wide = entry_by_name(&acfs, "wide");
+    assert(wide && wide->cluster_count == 3);
+    assert(wide->cluster_list[0] == acfs.header.sys_clusters + 1);
+    assert(wide->cluster_list[1] == acfs.header.sys_clusters + 3);
+    assert(wide->cluster_list[2] == acfs.header.sys_clusters + 8);
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    acfs_deinit(&acfs);
+    
+    // 连续段：同样的空洞布局下整段分配
+    config.allocator = NULL;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    assert(acfs.allocator == &acfs_allocator_extent);
+    assert(acfs_delete(&acfs, "wide") == ACFS_OK);
+    assert(acfs_write(&acfs, "wide", data, 3 * 128) == ACFS_OK);
+    wide = entry_by_name(&acfs, "wide");
+    assert(wide && wide->cluster_count == 3);
+    assert(wide->cluster_list[1] == wide->cluster_list[0] + 1);
+    assert(wide->cluster_list[2] == wide->cluster_list[0] + 2);
+    assert(acfs_get_alloc_stats(&acfs, &stats) == ACFS_OK);
+    assert(stats.free_clusters == acfs.header.free_clusters);
+    assert(stats.free_extents == 3);
+    check_extent_index(&acfs);
+    acfs_deinit(&acfs);
+    
+    // 自定义策略：从高地址向低地址分配，预留需要连续段时失败
+    config.allocator = &top_down_allocator;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    assert(acfs_write(&acfs, "top", data, 2 * 128) == ACFS_OK);
+    const acfs_data_entry_t* top = entry_by_name(&acfs, "top");
+    assert(top && top->cluster_list[0] == acfs.header.total_clusters - 1);
+    assert(top->cluster_list[1] == acfs.header.total_clusters - 2);
+    assert(acfs_reserve(&acfs, "big", 2 * 128) == ACFS_ERROR_NO_SPACE);
+    assert(acfs_delete(&acfs, "top") == ACFS_OK);
+    assert(acfs_defragment(&acfs) == ACFS_OK);
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    
+    // 任一策略写入的数据在其他策略下都可读取
+    uint8_t buffer[128];
+    size_t size = 0;
+    assert(acfs_read(&acfs, "a0", buffer, sizeof(buffer), &size) == ACFS_OK && size == 100);
+    acfs_deinit(&acfs);
+    
+    // 策略挂载失败时初始化失败并释放已加载的条目
+    config.allocator = &failing_allocator;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_ERROR_NO_SPACE);
+    assert(!acfs.initialized);
+    
+    acfs_destroy_storage_device(&storage);
+    printf("✓ 分配策略测试通过\n");
+}
+
+/* 分组内各数据首簇的最大跨度 */
+static uint16_t group_spread(const acfs_t* acfs, const char* prefix)
+{
+    uint16_t low = 0xFFFF;
+    uint16_t high = 0;
+    for (uint16_t i = 0; i < acfs->header.data_entries; i++) {
+        const acfs_data_entry_t* entry = &acfs->entries[i];
+        if (!entry->is_valid || strncmp(entry->data_id, prefix, strlen(prefix)) != 0) {
+            continue;
+        }
+        for (uint16_t j = 0; j < entry->cluster_count; j++) {
+            if (entry->cluster_list[j] < low) {
+                low = entry->cluster_list[j];
+            }
+            if (entry->cluster_list[j] > high) {
+                high = entry->cluster_list[j];
+            }
+        }
+    }
+    return high - low;
+}
+
+void test_placement_group()
+{
+    printf("测试: 放置分组\n");
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 48,
+        .format_if_invalid = true,
+        .enable_crc_check = true,
+        .group_separator = '/',
+        .group_regions = 8
+    };
+    
+    uint8_t data[2 * 128];
+    memset(data, 0x5A, sizeof(data));
+    char name[24];
+    
+    const acfs_allocator_t* allocators[] = { &acfs_allocator_extent, &acfs_allocator_first_fit };
+    for (int a = 0; a < 2; a++) {
+        config.allocator = allocators[a];
+        storage_device_t storage;
+        acfs_create_eeprom_device(&storage, 0x0000, 64 * 1024);
+        acfs_t acfs;
+        memset(&acfs, 0, sizeof(acfs));
+        assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+        
+        // 三个分组和不分组的数据交替写入，每组10簇
+        for (int i = 0; i < 10; i++) {
+            snprintf(name, sizeof(name), "dev/1/k%d", i);
+            assert(acfs_write(&acfs, name, data, 100) == ACFS_OK);
+            snprintf(name, sizeof(name), "dev/2/k%d", i);
+            assert(acfs_write(&acfs, name, data, 100) == ACFS_OK);
+            snprintf(name, sizeof(name), "plain%d", i);
+            assert(acfs_write(&acfs, name, data, 100) == ACFS_OK);
+            snprintf(name, sizeof(name), "e%d", i);
+            assert(acfs_write_group(&acfs, name, "sensor", data, 100) == ACFS_OK);
+        }
+        // 不分组时四类数据交错，跨度约40簇；分组后每组集中在各自区域（区域重合时与另一组交错）
+        assert(group_spread(&acfs, "dev/1/") < 20);
+        assert(group_spread(&acfs, "dev/2/") < 20);
+        assert(group_spread(&acfs, "e") < 20);
+        if (allocators[a] == &acfs_allocator_extent) {
+            check_extent_index(&acfs);
+        }
+        assert(acfs_check_integrity(&acfs) == ACFS_OK);
+        acfs_deinit(&acfs);
+        acfs_destroy_storage_device(&storage);
+    }
+    
+    printf("✓ 放置分组测试通过\n");
+}
+
+void test_magazine()
+{
+    printf("测试: 单簇分配缓存\n");
+    
+    storage_device_t storage;
+    acfs_create_eeprom_device(&storage, 0x0000, 8 * 1024);
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 32,
+        .format_if_invalid = true,
+        .enable_crc_check = true,
+        .magazine_size = 8
+    };
+    
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    
+    size_t free_before;
+    acfs_get_free_space(&acfs, &free_before);
+    
+    // 首次单簇分配补充一段，其余簇仍计入空闲空间
+    uint8_t data[3 * 128];
+    memset(data, 0x4D, sizeof(data));
+    assert(acfs_write(&acfs, "m0", data, 100) == ACFS_OK);
+    assert(acfs.magazine.remaining == 7);
+    size_t free_after;
+    acfs_get_free_space(&acfs, &free_after);
+    assert(free_after == free_before - 128);
+    
+    acfs_alloc_stats_t stats;
+    assert(acfs_get_alloc_stats(&acfs, &stats) == ACFS_OK);
+    assert(stats.free_clusters == acfs.header.free_clusters);
+    
+    // 连续的单簇数据相邻存放；缓存足够时多簇数据也取自缓存，否则交给分配策略
+    uint16_t first = entry_by_name(&acfs, "m0")->cluster_list[0];
+    char name[16];
+    for (int i = 1; i < 5; i++) {
+        snprintf(name, sizeof(name), "m%d", i);
+        assert(acfs_write(&acfs, name, data, 100) == ACFS_OK);
+        assert(entry_by_name(&acfs, name)->cluster_list[0] == first + i);
+    }
+    assert(acfs_write(&acfs, "multi", data, sizeof(data)) == ACFS_OK);
+    assert(acfs.magazine.remaining == 0);
+    assert(entry_by_name(&acfs, "multi")->cluster_list[0] == first + 5);
+    assert(acfs_write(&acfs, "multi2", data, sizeof(data)) == ACFS_OK);
+    assert(acfs.magazine.remaining == 0);
+    
+    // 写满时缓存中的簇归还后照常分配
+    int written = 0;
+    for (int i = 0; ; i++) {
+        snprintf(name, sizeof(name), "f%d", i);
+        if (acfs_write(&acfs, name, data, 100) != ACFS_OK) {
+            break;
+        }
+        written++;
+    }
+    assert(acfs.header.free_clusters == 0);
+    assert(acfs.magazine.remaining == 0);
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    
+    // 预留和碎片整理前归还缓存
+    for (int i = 0; i < written; i += 2) {
+        snprintf(name, sizeof(name), "f%d", i);
+        assert(acfs_delete(&acfs, name) == ACFS_OK);
+    }
+    assert(acfs_write(&acfs, "m5", data, 100) == ACFS_OK);
+    assert(acfs_defragment(&acfs) == ACFS_OK);
+    assert(acfs.magazine.remaining == 0);
+    assert(acfs_reserve(&acfs, "r", 2 * 128) == ACFS_OK);
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    
+    // 缓存不持久化，重新挂载后其中的簇为空闲
+    assert(acfs_release_reservation(&acfs, "r") == ACFS_OK);
+    assert(acfs_write(&acfs, "m6", data, 100) == ACFS_OK);
+    acfs_get_free_space(&acfs, &free_before);
+    acfs_deinit(&acfs);
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    acfs_get_free_space(&acfs, &free_after);
+    assert(free_after == free_before);
+    assert(acfs_get_alloc_stats(&acfs, &stats) == ACFS_OK);
+    assert(stats.free_clusters == acfs.header.free_clusters);
+    
+    acfs_deinit(&acfs);
+    acfs_destroy_storage_device(&storage);
+    printf("✓ 单簇分配缓存测试通过\n");
+}
+
+/* 执行器测试任务：记录每个工作项的执行次数和执行它的工作线程，前几项耗时较长以触发窃取 */
+typedef struct {
+    uint8_t hits[1000];
+    uint32_t per_worker[4];
+    uint32_t sink[4];
+} executor_probe_t;
+
+static void probe_task(void* arg, uint32_t index, uint16_t worker)
+{
+    executor_probe_t* probe = (executor_probe_t*)arg;
+    assert(worker < 4);
+    uint32_t spin = index < 250 ? 20000 : 10;
+    for (uint32_t i = 0; i < spin; i++) {
+        probe->sink[worker] += i ^ index;
+    }
+    probe->hits[index]++;
+    probe->per_worker[worker]++;
+}
+
+/* 宿主线程池的替身：在调用线程中倒序执行，记录调用次数 */
+static uint32_t host_calls;
+
+static void host_parallel_for(void* context, acfs_task_t task, void* arg, uint32_t count)
+{
+    (void)context;
+    host_calls++;
+    for (uint32_t i = count; i > 0; i--) {
+        task(arg, i - 1, 0);
+    }
+}
+
+void test_executor()
+{
+    printf("测试: 执行器\n");
+    
+    // 每个工作项恰好执行一次
+    acfs_executor_t executor;
+    assert(acfs_executor_create(&executor, 0) == ACFS_ERROR_INVALID_PARAM);
+    assert(acfs_executor_create(&executor, 4) == ACFS_OK);
+    assert(executor.workers == 4);
+    
+    static executor_probe_t probe;
+    for (int round = 0; round < 3; round++) {
+        memset(&probe, 0, sizeof(probe));
+        executor.parallel_for(executor.context, probe_task, &probe, 1000);
+        uint32_t total = 0;
+        for (int i = 0; i < 1000; i++) {
+            assert(probe.hits[i] == 1);
+        }
+        for (int w = 0; w < 4; w++) {
+            total += probe.per_worker[w];
+        }
+        assert(total == 1000);
+    }
+    executor.parallel_for(executor.context, probe_task, &probe, 0);
+    
+    // 完整性检查经执行器并行校验
+    storage_device_t storage;
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 32,
+        .format_if_invalid = true,
+        .enable_crc_check = true,
+        .executor = &executor
+    };
+    
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    
+    uint8_t data[300];
+    char name[16];
+    for (int i = 0; i < 40; i++) {
+        memset(data, i, sizeof(data));
+        snprintf(name, sizeof(name), "v%d", i);
+        assert(acfs_write(&acfs, name, data, 1 + (i * 7) % sizeof(data)) == ACFS_OK);
+    }
+    assert(acfs_ring_create(&acfs, "ring", 16, 8) == ACFS_OK);
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    
+    // 损坏一条数据，按槽位顺序报告
+    const acfs_data_entry_t* victim = entry_by_name(&acfs, "v17");
+    uint32_t addr = storage.start_addr + victim->cluster_list[0] * acfs.header.cluster_size;
+    uint8_t byte = 0xEE;
+    assert(storage.ops.write(addr, &byte, 1) == 0);
+    assert(acfs_check_integrity(&acfs) == ACFS_ERROR_DATA_CORRUPTED);
+    acfs_deinit(&acfs);
+    
+    // 接入宿主的线程池
+    acfs_executor_t host = { host_parallel_for, 1, NULL };
+    config.executor = &host;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    assert(acfs_check_integrity(&acfs) == ACFS_ERROR_DATA_CORRUPTED);
+    assert(host_calls == 1);
+    assert(acfs_delete(&acfs, "v17") == ACFS_OK);
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    assert(host_calls == 2);
+    acfs_deinit(&acfs);
+    
+    acfs_destroy_storage_device(&storage);
+    assert(acfs_executor_destroy(&host) == ACFS_ERROR_INVALID_PARAM);
+    assert(acfs_executor_destroy(&executor) == ACFS_OK);
+    printf("✓ 执行器测试通过\n");
+}
+
+/* 包装内置执行器，统计两项一批的提交次数（流水线的级数） */
+static acfs_executor_t pipeline_inner;
+static uint32_t pipeline_stages;
+
+static void counting_parallel_for(void* context, acfs_task_t task, void* arg, uint32_t count)
+{
+    if (count == 2) {
+        pipeline_stages++;
+    }
+    pipeline_inner.parallel_for(context, task, arg, count);
+}
+
+void test_pipeline()
+{
+    printf("测试: 流水线读写\n");
+    
+    assert(acfs_executor_create(&pipeline_inner, 2) == ACFS_OK);
+    acfs_executor_t executor = { counting_parallel_for, pipeline_inner.workers, pipeline_inner.context };
+    
+    storage_device_t storage;
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 8,
+        .format_if_invalid = true,
+        .enable_crc_check = true,
+        .enable_cluster_trailer = true,
+        .executor = &executor
+    };
+    
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    
+    // 不足一级的数据不走流水线
+    static uint8_t data[6000];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 31 + 7);
+    }
+    assert(acfs_write(&acfs, "small", data, 500) == ACFS_OK);
+    assert(pipeline_stages == 0);
+    
+    // 大数据分散写入，段边界与簇边界错开
+    acfs_iovec_t iov[4] = {
+        { data, 1000 },
+        { data + 1000, 0 },
+        { data + 1000, 2333 },
+        { data + 3333, sizeof(data) - 3333 }
+    };
+    assert(acfs_writev(&acfs, "big", iov, 4) == ACFS_OK);
+    const acfs_data_entry_t* big = entry_by_name(&acfs, "big");
+    uint16_t stages = (big->cluster_count + ACFS_PIPELINE_CLUSTERS - 1) / ACFS_PIPELINE_CLUSTERS;
+    assert(stages > 2);
+    assert(pipeline_stages == stages + 1u);
+    assert(big->crc32 == acfs_crc32(data, sizeof(data)));
+    
+    static uint8_t buffer[6000];
+    size_t size = 0;
+    assert(acfs_read(&acfs, "big", buffer, sizeof(buffer), &size) == ACFS_OK);
+    assert(size == sizeof(data) && memcmp(buffer, data, sizeof(data)) == 0);
+    assert(pipeline_stages == 2 * (stages + 1u));
+    assert(acfs_check_integrity(&acfs) == ACFS_OK);
+    acfs_deinit(&acfs);
+    
+    // 末簇尾部的CRC正确，元数据可由尾部重建
+    assert(acfs_fsck(&storage, &config, NULL) == ACFS_OK);
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    memset(buffer, 0, sizeof(buffer));
+    assert(acfs_read(&acfs, "big", buffer, sizeof(buffer), &size) == ACFS_OK);
+    assert(memcmp(buffer, data, sizeof(data)) == 0);
+    
+    // 中间一段损坏时报告CRC错误
+    big = entry_by_name(&acfs, "big");
+    uint32_t addr = storage.start_addr + big->cluster_list[ACFS_PIPELINE_CLUSTERS + 1] * acfs.header.cluster_size;
+    uint8_t byte = 0;
+    storage.ops.read(addr, &byte, 1);
+    byte ^= 0xFF;
+    assert(storage.ops.write(addr, &byte, 1) == 0);
+    assert(acfs_read(&acfs, "big", buffer, sizeof(buffer), &size) == ACFS_ERROR_CRC_MISMATCH);
+    acfs_deinit(&acfs);
+    
+    acfs_destroy_storage_device(&storage);
+    assert(acfs_executor_destroy(&pipeline_inner) == ACFS_OK);
+    printf("✓ 流水线读写测试通过\n");
+}
+
+void test_prefetch()
+{
+    printf("测试: 预取\n");
+    
+    acfs_executor_t executor;
+    assert(acfs_executor_create(&executor, 2) == ACFS_OK);
+    
+    storage_device_t storage;
+    acfs_create_eeprom_device(&storage, 0x0000, 32 * 1024);
+    counted_read_next = storage.ops.read;
+    storage.ops.read = counted_read;
+    
+    acfs_config_t config = {
+        .cluster_size = 128,
+        .reserved_clusters = 8,
+        .format_if_invalid = true,
+        .enable_crc_check = true,
+        .executor = &executor
+    };
+    
+    // 未启用值缓存时不能预取
+    acfs_t acfs;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    const char* ids[] = { "c", "missing", "a", "d", "b", "a" };
+    assert(acfs_prefetch(&acfs, ids, 6, NULL) == ACFS_ERROR_INVALID_PARAM);
+    
+    static uint8_t data[1400];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 13 + 5);
+    }
+    assert(acfs_write(&acfs, "a", data, 300) == ACFS_OK);
+    assert(acfs_write(&acfs, "b", data + 1, 300) == ACFS_OK);
+    assert(acfs_write(&acfs, "c", data + 2, 300) == ACFS_OK);
+    assert(acfs_write(&acfs, "d", data, sizeof(data)) == ACFS_OK);
+    assert(acfs_ring_create(&acfs, "ring", 16, 4) == ACFS_OK);
+    acfs_deinit(&acfs);
+    
+    // 相邻的20个簇合并为两次设备读取，重复和不存在的标识被忽略
+    config.value_cache_size = 4096;
+    memset(&acfs, 0, sizeof(acfs));
+    assert(acfs_init(&acfs, &storage, &config) == ACFS_OK);
+    uint16_t loaded = 0;
+    counted_reads = 0;
+    assert(acfs_prefetch(&acfs, ids, 6, &loaded) == ACFS_OK);
+    assert(loaded == 4 && counted_reads == 2);
+    
+    // 预取的数据从缓存返回
+    const char* names[] = { "a", "b", "c" };
+    for (int i = 0; i < 3; i++) {
+        corrupt_first_cluster(&acfs, &storage, names[i]);
+    }
+    static uint8_t buffer[1400];
+    size_t size = 0;
+    counted_reads = 0;
+    for (int i = 0; i < 3; i++) {
+        assert(acfs_read(&acfs, names[i], buffer, sizeof(buffer), &size) == ACFS_OK);
+        assert(size == 300 && memcmp(buffer, data + i, 300) == 0);
+    }
+    assert(acfs_read(&acfs, "d", buffer, sizeof(buffer), &size) == ACFS_OK);
+    assert(size == sizeof(data) && memcmp(buffer, data, sizeof(data)) == 0);
+    assert(counted_reads == 0);
+    
+    // 已缓存的数据不再读取，环形记录和不存在的标识被忽略，没有要读取的数据时直接成功
+    const char* again[] = { "d", "ring", "missing" };
+    loaded = 1;
+    assert(acfs_prefetch(&acfs, again, 3, &loaded) == ACFS_OK);
+    assert(loaded == 0 && counted_reads == 0);
+    
+    // 校验失败的数据不进入缓存，读取时报告错误
+    assert(acfs_write(&acfs, "a", data, 300) == ACFS_OK);
+    corrupt_first_cluster(&acfs, &storage, "a");
+    assert(acfs_prefetch(&acfs, names, 1, &loaded) == ACFS_OK);
+    assert(loaded == 0);
+    assert(acfs_read(&acfs, "a", buffer, sizeof(buffer), &size) == ACFS_ERROR_CRC_MISMATCH);
+    acfs_deinit(&acfs);
+    
+    acfs_destroy_storage_device(&storage);
+    assert(acfs_executor_destroy(&executor) == ACFS_OK);
+    printf("✓ 预取测试通过\n");
+}
+
 int main()
 {
     printf("=== ACFS 单元测试 ===\n");
@@ -241,6 +2784,31 @@ int main()
     test_delete();
     test_stats();
     test_error_handling();
+    test_cluster_owner();
+    test_fsck();
+    test_replica();
+    test_rename();
+    test_write_if_version();
+    test_snapshot();
+    test_export_import();
+    test_export_since();
+    test_ttl();
+    test_cache_mode();
+    test_value_cache();
+    test_writev();
+    test_ring();
+    test_queue();
+    test_counter();
+    test_stat();
+    test_resize();
+    test_reserve();
+    test_extent_index();
+    test_allocator();
+    test_placement_group();
+    test_magazine();
+    test_executor();
+    test_pipeline();
+    test_prefetch();
     
     printf("\n所有测试通过！✓\n");
     return 0;